@@ -0,0 +1,167 @@
+// Measures the exec-to-exit time of envc for the list and cmp paths.
+//
+// Usage: startup <path to envc> [iterations]
+
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_ITERATIONS 2000
+#define BENCH_WARMUP             50
+
+extern char **environ;
+
+typedef struct BenchCase {
+    const char *name;
+    char       *argv[8];
+} bench_case_t;
+
+static int    write_fixture(const char *path, const char *contents);
+static double now_us(void);
+static int    run_once(const char *bin, char **argv, double *elapsed);
+static int    compare_doubles(const void *a, const void *b);
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <path to envc> [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *bin        = argv[1];
+    int         iterations = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_ITERATIONS;
+
+    if (iterations <= 0) {
+        fprintf(stderr, "Invalid iteration count: %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    char dir[] = "/tmp/envc-bench-XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    char target[sizeof(dir) + 16];
+    char source[sizeof(dir) + 16];
+    snprintf(target, sizeof(target), "%s/.env", dir);
+    snprintf(source, sizeof(source), "%s/.env.example", dir);
+
+    if (write_fixture(target, "AAA=\nBBB=\"aaa\"\nCCC=false\nDDD=\nFFF=\"fff\"\n") != 0 ||
+        write_fixture(source, "AAA=\"aaa\"\nBBB=\nCCC=true\nDDD=1\n") != 0) {
+        perror("write fixture");
+        return EXIT_FAILURE;
+    }
+
+    bench_case_t cases[] = {
+        {"list", {"envc", "list", "-t", target, NULL}},
+        {"cmp", {"envc", "cmp", "-t", target, "-s", source, NULL}},
+    };
+
+    double *samples = malloc(iterations * sizeof(*samples));
+    if (samples == NULL) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-6s %10s %10s %10s %10s   (us, %d runs)\n", "path", "min", "median", "mean", "p95", iterations);
+
+    int code = EXIT_SUCCESS;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]) && code == EXIT_SUCCESS; ++c) {
+        bench_case_t *bc = &cases[c];
+        double        elapsed;
+
+        for (int i = 0; i < BENCH_WARMUP; ++i) {
+            if (run_once(bin, bc->argv, &elapsed) != 0) {
+                code = EXIT_FAILURE;
+                break;
+            }
+        }
+
+        double sum = 0;
+        for (int i = 0; i < iterations && code == EXIT_SUCCESS; ++i) {
+            if (run_once(bin, bc->argv, &samples[i]) != 0) {
+                code = EXIT_FAILURE;
+                break;
+            }
+            sum += samples[i];
+        }
+
+        if (code != EXIT_SUCCESS) {
+            fprintf(stderr, "Running '%s' failed\n", bc->name);
+            break;
+        }
+
+        qsort(samples, iterations, sizeof(*samples), compare_doubles);
+        printf("%-6s %10.1f %10.1f %10.1f %10.1f\n",
+               bc->name,
+               samples[0],
+               samples[iterations / 2],
+               sum / iterations,
+               samples[(size_t) (iterations * 0.95)]);
+    }
+
+    free(samples);
+    unlink(target);
+    unlink(source);
+    rmdir(dir);
+
+    return code;
+}
+
+static int write_fixture(const char *path, const char *contents) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+    fputs(contents, file);
+    return fclose(file);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Spawns envc with its output discarded and waits for it to exit.
+static int run_once(const char *bin, char **argv, double *elapsed) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    pid_t  pid;
+    int    status;
+    double start = now_us();
+    int    err   = posix_spawn(&pid, bin, &actions, NULL, argv, environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (err != 0) {
+        fprintf(stderr, "posix_spawn: %s\n", strerror(err));
+        return -1;
+    }
+
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            perror("waitpid");
+            return -1;
+        }
+    }
+
+    *elapsed = now_us() - start;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
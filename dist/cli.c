@@ -17,14 +17,32 @@
 // TODO: -n, --no-interaction option
 // TODO: --profile option
 
+static option_t   help_opt      = OPTION_BOOL("help", "h", "Display help.");
+static option_t   quiet_opt     = OPTION_BOOL("quiet", "q", "Do not output any message.");
+static option_t   ansi_opt      = {.name    = "ansi",
+                                   .desc    = "Force (or disable) ANSI output.",
+                                   .boolval = true,
+                                   .__flag  = OPTION_NO_VALUE | OPTION_VALUE_NEGATABLE};
+static option_t   version_opt   = OPTION_BOOL("version", "V", "Show the current version of the program.");
+static option_t   verbosity_opt = OPTION("verbose", "v", "Set the log level for the program.", OPTION_LEVELS);
+
+static option_t  *global_optv_versioned[]   = {&help_opt, &quiet_opt, &ansi_opt, &version_opt, &verbosity_opt};
+static option_t  *global_optv_unversioned[] = {&help_opt, &quiet_opt, &ansi_opt, &verbosity_opt};
+
+// Option index seeds of the tables above, see option_index_seed(). A seed
+// that collides panics on startup, `make check` catches it at build time.
+#define GLOBAL_OPTV_VERSIONED_SEED   0
+#define GLOBAL_OPTV_UNVERSIONED_SEED 0
+
 static option_t **global_optv = NULL;
 static size_t     global_optc = 0;
+static option_index_t global_index;
 
 static int        do_run_command(command_t *cmd, int argc, char **argv, int offset);
 static void       cleanup(command_t *cmd);
-static void       free_global_opts(void);
 bool              register_global_opt(option_t *opt);
 static void       create_global_opts(bool has_version);
+static bool       check_option_table(const char *name, option_t **optv, size_t optc, unsigned int seed);
 static void       command_append_global_opts(command_t *cmd, option_t **buf, size_t buflen);
 static bool       handle_ansi_opt(void);
 static bool       handle_verbosity_opt(void);
@@ -46,15 +64,14 @@ int               run_application(program_t *program, int argc, char **argv) {
 
     // program invoked without any args, print usage
     if (argc <= 1) {
-        int code = usage(program, false);
-        free_global_opts();
-        return code;
+        return usage(program, false);
     }
 
     // parse input
     char errbuf[1024];
     errbuf[0] = '\0';
     input_parser_t parser = input_parser_create(program->argv, program->argc, program->optv, program->optc, errbuf, 1);
+    parser.index          = &global_index;
     argument_validate_order(program->argv, program->argc);
     input_parse(&parser, argc, argv);
 
@@ -62,12 +79,10 @@ int               run_application(program_t *program, int argc, char **argv) {
     handle_global_optv();
 
     // usage (help or version)
-    bool wants_help   = option_get_bool(program->optv, program->optc, "help");
-    bool show_version = option_get_bool(program->optv, program->optc, "version");
+    bool wants_help   = help_opt.boolval;
+    bool show_version = program->version != NULL && version_opt.boolval;
     if (wants_help || show_version) {
-        int code = usage(program, show_version);
-        free_global_opts();
-        return code;
+        return usage(program, show_version);
     }
 
     // exit if input error
@@ -75,7 +90,6 @@ int               run_application(program_t *program, int argc, char **argv) {
         erro(errbuf);
         new_line();
         usage_string_cmd("command", program->optv, program->optc, NULL, 0);
-        free_global_opts();
         return EXIT_FAILURE;
     }
 
@@ -84,9 +98,7 @@ int               run_application(program_t *program, int argc, char **argv) {
 
     // if no command is given, print usage
     if (!cmd) {
-        int code = usage(program, false);
-        free_global_opts();
-        return code;
+        return usage(program, false);
     }
 
     // find and run command
@@ -94,12 +106,10 @@ int               run_application(program_t *program, int argc, char **argv) {
     int         found = command_find_loose(program->cmdv, program->cmdc, cmd, matches, program->cmdc);
 
     if (found == 0) {
-        free_global_opts();
         panicf("Unknown command: \"%s\"", cmd);
     }
 
     if (found > 1) {
-        free_global_opts();
         char errbuf[1024];
         sprintf(errbuf,
                 "command_t \"%s\" is ambigious.\n"
@@ -116,7 +126,6 @@ int               run_application(program_t *program, int argc, char **argv) {
     if (cmdlen > matchlen || (cmdlen == matchlen && !str_equals(cmd, matches[0]))) {
         log_level_t log_level = get_log_level();
         if (log_level == LOG_LEVEL_QUIET) {
-            free_global_opts();
             return EXIT_FAILURE;
         }
 
@@ -138,7 +147,6 @@ int               run_application(program_t *program, int argc, char **argv) {
             command = command_find(program->cmdv, program->cmdc, matches[0]);
             new_line();
         } else {
-            free_global_opts();
             return 1;
         }
     } else {
@@ -154,56 +162,67 @@ int               run_application(program_t *program, int argc, char **argv) {
     return do_run_command(command, argc, argv, parser.offset + parser.parsed);
 }
 
+// Checks the hard-coded index seed of every option table: the global tables
+// and each command's table merged with the globals it runs with.
+bool check_option_indexes(program_t *program) {
+    assert(program != NULL);
+
+    bool ok = check_option_table(
+        "global options", global_optv_versioned, ARRAY_LEN(global_optv_versioned), GLOBAL_OPTV_VERSIONED_SEED);
+    ok = check_option_table("unversioned global options",
+                            global_optv_unversioned,
+                            ARRAY_LEN(global_optv_unversioned),
+                            GLOBAL_OPTV_UNVERSIONED_SEED) &&
+         ok;
+
+    create_global_opts(program->version != NULL);
+
+    for (size_t i = 0; i < program->cmdc; ++i) {
+        command_t *cmd  = program->cmdv[i];
+        size_t     optc = cmd->optc + global_optc;
+        option_t  *optv[optc];
+
+        memcpy(optv, cmd->optv, cmd->optc * sizeof(*optv));
+        memcpy(optv + cmd->optc, global_optv, global_optc * sizeof(*optv));
+
+        ok = check_option_table(cmd->name, optv, optc, cmd->optseed) && ok;
+    }
+
+    return ok;
+}
+
 int run_command(command_t *cmd, int argc, char *argv[]) {
     return do_run_command(cmd, argc, argv, cmd->handler ? 2 : 1);
 }
 
+// The global options are static, so picking the table is all there is to do.
 static void create_global_opts(bool has_version) {
     if (global_optv != NULL) {
         return;
     }
 
-    option_t *help_opt      = malloc(sizeof(*help_opt));
-    option_t *quiet_opt     = malloc(sizeof(*help_opt));
-    option_t *ansi_opt      = malloc(sizeof(*help_opt));
-    option_t *version_opt   = NULL;
-    option_t *verbosity_opt = malloc(sizeof(*help_opt));
-
-    assert(help_opt != NULL);
-    assert(quiet_opt != NULL);
-    assert(ansi_opt != NULL);
-    assert(verbosity_opt != NULL);
-
-    option_init(help_opt, "help", "h", "Display help.");
-    option_init(quiet_opt, "quiet", "q", "Do not output any message.");
-    option_init(ansi_opt, "ansi", NULL, "Force (or disable) ANSI output.");
-    option_add_flag(ansi_opt, OPTION_VALUE_NEGATABLE);
-    option_set_boolval(ansi_opt, true);
-    option_init(verbosity_opt, "verbose", "v", "Set the log level for the program.");
-    option_set_flag(verbosity_opt, OPTION_LEVELS);
-
-    global_optc = 4;
-    if (has_version) {
-        version_opt = malloc(sizeof(*help_opt));
-        assert(version_opt != NULL);
-        option_init(version_opt, "version", "V", "Show the current version of the program.");
-        ++global_optc;
-    }
+    unsigned int seed;
 
-    global_optv = malloc((global_optc + 1) * sizeof(option_t *));
-    assert(global_optv != NULL);
-    global_optv[0] = help_opt;
-    global_optv[1] = quiet_opt;
-    global_optv[2] = ansi_opt;
     if (has_version) {
-        global_optv[global_optc - 2] = version_opt;
+        global_optv = global_optv_versioned;
+        global_optc = ARRAY_LEN(global_optv_versioned);
+        seed        = GLOBAL_OPTV_VERSIONED_SEED;
+    } else {
+        global_optv = global_optv_unversioned;
+        global_optc = ARRAY_LEN(global_optv_unversioned);
+        seed        = GLOBAL_OPTV_UNVERSIONED_SEED;
     }
-    global_optv[global_optc - 1] = verbosity_opt;
 
-    for (size_t i = 0; i < global_optc; ++i) {
-        option_t *opt = global_optv[i];
-        opt->__meta |= OPTION_META_CLEANUP_OPT;
+    option_index_build(&global_index, global_optv, global_optc, seed);
+}
+
+static bool check_option_table(const char *name, option_t **optv, size_t optc, unsigned int seed) {
+    if (option_index_fits(optv, optc, seed)) {
+        return true;
     }
+
+    errof("Option index seed %u of %s collides, use %d", seed, name, option_index_seed(optv, optc));
+    return false;
 }
 
 static int do_run_command(command_t *cmd, int argc, char **argv, int offset) {
@@ -214,18 +233,20 @@ static int do_run_command(command_t *cmd, int argc, char **argv, int offset) {
     size_t    optc = global_optc + cmd->optc;
     option_t *optv[optc];
     command_append_global_opts(cmd, optv, optc);
+    option_index_build(&cmd->__index, cmd->optv, cmd->optc, cmd->optseed);
 
     // parse input
     char errbuf[1024];
     errbuf[0]             = '\0';
     input_parser_t parser = input_parser_create(cmd->argv, cmd->argc, cmd->optv, cmd->optc, errbuf, offset);
+    parser.index          = &cmd->__index;
     argument_validate_order(cmd->argv, cmd->argc);
     input_parse(&parser, argc, argv);
 
     // handle default opts
     handle_global_optv();
 
-    bool wants_help = option_get_bool(cmd->optv, cmd->optc, "help");
+    bool wants_help = help_opt.boolval;
     if (wants_help) {
         usage_cmd(cmd);
         cleanup(cmd);
@@ -267,45 +288,23 @@ static void command_append_global_opts(command_t *cmd, option_t **buf, size_t bu
     cmd->optc = buflen;
 }
 
-static void free_global_opts(void) {
-    if (global_optv) {
-        for (size_t i = 0; i < global_optc; ++i) {
-            free(global_optv[i]);
-        }
-        free(global_optv);
-        global_optv = NULL;
-    }
-}
-
 static void cleanup(command_t *cmd) {
     assert(cmd != NULL);
 
-    // global opts should be merged here so be included in the cleanup
+    // global opts should be merged here so be included in the cleanup.
+    // option values point into argv, only value arrays are owned
     for (size_t i = 0; i < cmd->optc; ++i) {
         option_t *opt = cmd->optv[i];
         if (opt == NULL) {
             continue;
         }
 
-        if (opt->__meta & OPTION_META_CLEANUP_VALUE) {
-            free(opt->stringval);
-            opt->stringval = NULL;
-        }
-
         if (opt->__meta & OPTION_META_CLEANUP_VALUE_ARRAY) {
-            for (size_t i = 0; i < opt->stringc; ++i) {
-                free(opt->stringv[i]);
-                opt->stringv[i] = NULL;
-            }
             free(opt->stringv);
             opt->stringv = NULL;
             opt->stringc = 0;
         }
 
-        if (opt->__meta & OPTION_META_CLEANUP_OPT) {
-            free(opt);
-        }
-
         cmd->optv[i] = NULL;
     }
 
@@ -317,19 +316,10 @@ static void cleanup(command_t *cmd) {
         arg->valuev = NULL;
         arg->valuec = 0;
     }
-
-    if (global_optv) {
-        free(global_optv);
-        global_optv = NULL;
-    }
 }
 
 static bool handle_ansi_opt(void) {
-    option_t *opt = option_find(global_optv, global_optc, "ansi", NULL);
-
-    if (!opt) {
-        return false;
-    }
+    option_t *opt = &ansi_opt;
 
     if (opt->provided) {
         if (opt->boolval) {
@@ -343,9 +333,9 @@ static bool handle_ansi_opt(void) {
 }
 
 static bool handle_verbosity_opt(void) {
-    option_t *opt = option_find(global_optv, global_optc, "verbose", NULL);
+    option_t *opt = &verbosity_opt;
 
-    if (!opt || !opt->provided || opt->levelval <= 0) {
+    if (!opt->provided || opt->levelval <= 0) {
         return false;
     }
 
@@ -375,11 +365,7 @@ static bool handle_verbosity_opt(void) {
 }
 
 static bool handle_quiet_opt(void) {
-    option_t *opt = option_find(global_optv, global_optc, "quiet", "q");
-
-    if (!opt) {
-        return false;
-    }
+    option_t *opt = &quiet_opt;
 
     if (opt->boolval) {
         set_log_level(LOG_LEVEL_QUIET);
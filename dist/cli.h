@@ -10,5 +10,6 @@
 
 int run_application(program_t *program, int argc, char **argv);
 int run_command(command_t *cmd, int argc, char **argv);
+bool check_option_indexes(program_t *program);
 
 #endif // CLI_H
@@ -29,6 +29,8 @@ void               command_init(command_t *cmd, const char *name, const char *de
     cmd->argc           = 0;
     cmd->__default_optc = 0;
     cmd->__default_optv = NULL;
+    cmd->optseed        = 0;
+    cmd->__index.built  = false;
     cmd->handler        = NULL;
 }
 
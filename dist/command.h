@@ -4,6 +4,9 @@
 #include <argument.h>
 #include <option.h>
 
+// Static initializer, extra fields (e.g. .optv, .aliasv) may follow the op.
+#define COMMAND(__name, __desc, __op, ...) { .name = __name, .desc = __desc, .operation = __op, __VA_ARGS__ }
+
 typedef struct command_t command_t;
 
 typedef int(cmd_op_func)(command_t *cmd);
@@ -23,6 +26,8 @@ typedef struct command_t {
     size_t            argc;
     option_t        **__default_optv;
     size_t            __default_optc;
+    unsigned int      optseed; // index seed of optv merged with the global options
+    option_index_t    __index;
     cmd_handler_func *handler;
 } command_t;
 
@@ -5,15 +5,18 @@
 #include <colors.h>
 #include <cstring.h>
 #include <ctype.h>
-#include <fs.h>
+#include <errno.h>
 #include <ht.h>
 #include <input.h>
 #include <math-utils.h>
 #include <output.h>
+#include <reader.h>
+#include <schema.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <trie.h>
 
 //=== Defines ================================================================//
 #define ENVC_NAME "Env Check"
@@ -22,6 +25,16 @@
 # define VERSION NULL
 #endif // VERSION
 
+#define ENV_VAR_STATUS_COUNT 4
+
+// Group counters: one per status, plus schema violations which are tracked
+// apart from the status
+#define ENV_GROUP_COUNTER_COUNT (ENV_VAR_STATUS_COUNT + 1)
+#define ENV_GROUP_INVALID       ENV_VAR_STATUS_COUNT
+
+// Namespaces shared by fewer variables are not worth a row in the group view
+#define ENV_GROUP_MIN_SIZE   2
+
 #define ENVC_ASCII_ART                                                                                                 \
     "\
  _____ _   ___     __   ____ _   _ _____ ____ _  __ \n\
@@ -41,18 +54,69 @@ typedef enum EnvVarStatus {
 } env_var_status_t;
 
 typedef struct EnvVar {
-    char            *name;
-    char            *val;
-    char            *cmpval;
-    env_var_status_t status;
-    size_t           namelen;
-    size_t           vallen;
-    size_t           cmpvallen;
-    bool             interpolated;
+    char                *name;
+    char                *val;
+    char                *cmpval;
+    env_var_status_t     status;
+    size_t               namelen;
+    size_t               vallen;
+    size_t               cmpvallen;
+    bool                 interpolated;
+    bool                 invalid; // the target value breaks its schema rule
+    const schema_rule_t *rule;    // attached when the key is first read, owned by the schema
 } env_var_t;
 
 DEFINE_HASH_MAP(hash_table_t, env_var_t *);
 
+typedef struct EnvGroup {
+    char  *prefix;
+    size_t level;
+    size_t counts[ENV_GROUP_COUNTER_COUNT];
+} env_group_t;
+
+typedef struct EnvGroupFrame {
+    size_t counts[ENV_GROUP_COUNTER_COUNT];
+    size_t first;  // first group opened by the node
+    size_t opened; // groups opened by the node, one per '_' in its edge
+} env_group_frame_t;
+
+// Prefix patterns select or skip whole subtrees of the key trie, every other
+// pattern is matched against the keys met on the walk.
+typedef struct EnvSelection {
+    trie_node_t **skipv;    // subtrees of ignored prefixes
+    size_t        skipc;
+    const char  **patternv; // patterns matched against each key
+    size_t        patternc;
+    bool          focus;    // keep the keys matching a pattern instead of dropping them
+} env_selection_t;
+
+typedef struct EnvGroupWalk {
+    const env_selection_t *selection;
+    size_t                 base; // length of the prefix the walk started at
+    env_group_t           *groupv;
+    size_t                 groupc;
+    size_t                 groupcap;
+    env_group_frame_t     *framev; // one frame per node on the current path
+    size_t                 framecap;
+    size_t                 level;
+    size_t                 total[ENV_GROUP_COUNTER_COUNT];
+} env_group_walk_t;
+
+typedef struct EnvKeyWalk {
+    const env_selection_t *selection;
+    const char           **keyv;
+    size_t                 keyc;
+} env_key_walk_t;
+
+typedef struct EnvFileContext {
+    hash_table_t *ht;
+    trie_t       *trie;
+    bool          comparing;
+    bool          interpolate;
+    schema_t     *schema;
+    bool          validate;
+} env_file_ctx_t;
+
 //=== Prototypes =============================================================//
 hash_table_t ht_create(size_t cap);
 void         ht_free(hash_table_t *ht);
@@ -62,86 +126,130 @@ void         ht_keys(hash_table_t *ht, const char **buf, size_t size);
 void         free_env_var(env_var_t *var);
 void         free_strings(char **strv, size_t strc);
 void         create_env_var_from_line(hash_table_t *ht,
+                                      trie_t       *trie,
                                       const char   *line,
-                                      const char  **ignorev,
-                                      size_t        ignorec,
-                                      const char  **focusv,
-                                      size_t        focusc,
                                       bool          comparing,
-                                      bool          interpolate);
+                                      bool          interpolate,
+                                      schema_t     *schema,
+                                      bool          validate);
+void         validate_env_var(env_var_t *var, const char *value, size_t vallen);
+void         handle_env_line(char *line, size_t len, void *ctx);
 void         set_env_var_status(env_var_t *var);
 int          read_env_file(hash_table_t *ht,
+                           trie_t       *trie,
                            const char   *path,
-                           const char  **ignorev,
-                           size_t        ignorec,
-                           const char  **focusv,
-                           size_t        focusc,
                            bool          comparing,
-                           bool          interpolate);
+                           bool          interpolate,
+                           schema_t     *schema,
+                           bool          validate);
 size_t       find_max_width_in_array(env_var_t **varv, size_t varc, bool name);
 size_t       trim_string(char *str);
 bool         is_numeric(const char *str);
 bool         is_interpolated(const char *str);
 void         interpolate_env_vars(hash_table_t *ht, const char **keyv, size_t keyc);
 void         prepare_value_for_printing(const char *value, size_t vallen, char *buf, bool is_empty, int colwidth);
-void print_env_var(const env_var_t *var, int first_colwidth, int second_colwidth, int third_colwidth, bool comparing);
+void print_env_var(const env_var_t *var,
+                   int              first_colwidth,
+                   int              second_colwidth,
+                   int              third_colwidth,
+                   bool             comparing,
+                   bool             validating);
 void sort_env_vars_array(const char **keyv, size_t keyc);
 bool match_pattern(const char *str, const char *pattern);
+bool is_prefix_pattern(const char *pattern);
+bool match_env_pattern(const char *name, size_t namelen, const char *pattern);
+bool is_env_key_selected(const env_selection_t *selection, const char *key, size_t keylen);
+bool is_env_subtree_skipped(const env_selection_t *selection, const trie_node_t *node);
+bool collect_env_key(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx);
+bool enter_env_group(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx);
+void leave_env_group(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx);
+void print_env_groups(const env_group_walk_t *walk, bool comparing, bool validating);
 void print_title(const char *filename);
 int  handle_cmd(command_t *self);
 int  list(command_t *self);
 int  compare(command_t *self);
 
+//=== Shared options =========================================================//
+static option_t ignore_opt =
+    OPTION_STRING("ignore", "i", "Comma seperated list of variable name patterns to ignore", NULL, true);
+static option_t key_opt =
+    OPTION_STRING("key", "k", "Comma seperated list of variable name patterns to focus on", NULL, true);
+static option_t truncate_opt =
+    OPTION_STRING("truncate", "T", "The amount of chars to truncate keys or values to", "40", false);
+static option_t interpolate_opt = OPTION_BOOL("interpolate", "I", "Interpolate env var values that refer to other env vars");
+static option_t group_opt = OPTION_BOOL("group", "g", "Show variable counts per key prefix instead of the variables");
+static option_t schema_opt =
+    OPTION_STRING("schema", "S", "Path to a schema file to validate the target values against", NULL, false);
+static option_t invalid_opt = OPTION_BOOL("invalid", "E", "Show variables whose values break the schema");
+
+//=== Compare ================================================================//
+static option_t cmp_target_opt =
+    OPTION_STRING("target", "t", "Path to the .env file to compare with, or - for stdin", "./.env", false);
+static option_t cmp_source_opt =
+    OPTION_STRING("source", "s", "Path to the .env file to compare to, or - for stdin", "./.env.example", false);
+static option_t cmp_missing_opt = OPTION_BOOL("missing", "m", "Show missing and empty variables");
+static option_t cmp_undefined_opt =
+    OPTION_BOOL("undefined", "u", "Show variables in the target that aren't in the source file");
+static option_t    cmp_divergent_opt = OPTION_BOOL("divergent", "d", "Show variables with diverging values");
+static option_t   *cmp_optv[]        = {&cmp_target_opt,
+                                        &cmp_source_opt,
+                                        &ignore_opt,
+                                        &key_opt,
+                                        &truncate_opt,
+                                        &cmp_missing_opt,
+                                        &cmp_undefined_opt,
+                                        &cmp_divergent_opt,
+                                        &interpolate_opt,
+                                        &group_opt,
+                                        &schema_opt,
+                                        &invalid_opt};
+static const char *cmp_aliasv[]      = {"compare"};
+static command_t   compare_cmd       = COMMAND("cmp",
+                                       "Compares two env files files.",
+                                       compare,
+                                       .optv    = cmp_optv,
+                                       .optc    = ARRAY_LEN(cmp_optv),
+                                       .aliasv  = cmp_aliasv,
+                                       .aliasc  = ARRAY_LEN(cmp_aliasv),
+                                       .optseed = 7);
+
+//=== List ===================================================================//
+static option_t list_target_opt = OPTION_STRING("target", "t", "Path to the .env file, or - for stdin", "./.env", false);
+static option_t  *list_optv[] = {&list_target_opt,
+                                 &ignore_opt,
+                                 &key_opt,
+                                 &truncate_opt,
+                                 &interpolate_opt,
+                                 &group_opt,
+                                 &schema_opt,
+                                 &invalid_opt};
+static command_t  list_cmd    = COMMAND("list",
+                                     "Lists all variables in the target env file, sorted alphabetically.",
+                                     list,
+                                     .optv    = list_optv,
+                                     .optc    = ARRAY_LEN(list_optv),
+                                     .optseed = 2);
+
+//=== Env Check ==============================================================//
+static command_t *commands[] = {&compare_cmd, &list_cmd};
+static program_t  program    = PROGRAM(ENVC_NAME,
+                                   VERSION,
+                                   .cmdv = commands,
+                                   .cmdc = ARRAY_LEN(commands),
+                                   .art  = ENVC_ASCII_ART);
+
 //=== Main ===================================================================//
+// Options, commands and the program are static tables, so startup doesn't
+// build or allocate anything before parsing the input.
 int main(int argc, char **argv) {
-    //=== Shared options =====================================================//
-    option_t ignore_opt =
-        option_create_string_opt("ignore", "i", "Comma seperated list of variable name patterns to ignore", NULL, true);
-    option_t key_opt =
-        option_create_string_opt("key", "k", "Comma seperated list of variable name patterns to focus on", NULL, true);
-    option_t truncate_opt =
-        option_create_string_opt("truncate", "T", "The amount of chars to truncate keys or values to", "40", false);
-    option_t interpolate_opt = option_create("interpolate", "I", "Interpolate env var values that refer to other env vars");
-
-    //=== Compare ============================================================//
-    command_t compare_cmd = command_create("cmp", "Compares two env files files.", compare);
-    option_t  cmp_target_opt =
-        option_create_string_opt("target", "t", "Path to the .env file to compare with", "./.env", false);
-    option_t cmp_source_opt =
-        option_create_string_opt("source", "s", "Path to the .env file to compare to", "./.env.example", false);
-    option_t cmp_missing_opt = option_create("missing", "m", "Show missing and empty variables");
-    option_t cmp_undefined_opt =
-        option_create("undefined", "u", "Show variables in the target that aren't in the source file");
-    option_t  cmp_divergent_opt = option_create("divergent", "d", "Show variables with diverging values");
-    option_t *cmp_opts[]        = {&cmp_target_opt,
-                                   &cmp_source_opt,
-                                   &ignore_opt,
-                                   &key_opt,
-                                   &truncate_opt,
-                                   &cmp_missing_opt,
-                                   &cmp_undefined_opt,
-                                   &cmp_divergent_opt,
-                                   &interpolate_opt};
-    compare_cmd.optv            = cmp_opts;
-    compare_cmd.optc            = ARRAY_LEN(cmp_opts);
-    const char *aliasv[]        = {"compare"};
-    command_set_aliases(&compare_cmd, aliasv, ARRAY_LEN(aliasv));
-
-    //=== List ===============================================================//
-    command_t list_cmd =
-        command_create("list", "Lists all variables in the target env file, sorted alphabetically.", list);
-    option_t  list_target_opt = option_create_string_opt("target", "t", "Path to the .env file", "./.env", false);
-    option_t *list_optv[]     = {&list_target_opt, &ignore_opt, &key_opt, &truncate_opt, &interpolate_opt};
-    list_cmd.optv             = list_optv;
-    list_cmd.optc             = ARRAY_LEN(list_optv);
-
-    //=== Env Check ==========================================================//
-    command_t *commands[] = {&compare_cmd, &list_cmd};
-    program_t  program    = program_create(ENVC_NAME, VERSION);
-    program_set_subcommands(&program, commands, ARRAY_LEN(commands));
-    program_set_ascii_art(&program, ENVC_ASCII_ART);
-
+#ifdef CHECK_OPTION_INDEXES
+    // built by `make check`, fails when a hard-coded option index seed collides
+    (void) argc;
+    (void) argv;
+    return check_option_indexes(&program) ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
     return run_application(&program, argc, argv);
+#endif // CHECK_OPTION_INDEXES
 }
 
 //=== hash_table_t ===========================================================//
@@ -270,7 +378,12 @@ void prepare_value_for_printing(const char *val, size_t vallen, char *buf, bool
     }
 }
 
-void print_env_var(const env_var_t *var, int first_colwidth, int second_colwidth, int third_colwidth, bool comparing) {
+void print_env_var(const env_var_t *var,
+                   int              first_colwidth,
+                   int              second_colwidth,
+                   int              third_colwidth,
+                   bool             comparing,
+                   bool             validating) {
     char *keyclr         = WHITE_BOLD;
     char *boolclr        = CYAN;
     char *numclr         = EMERALD;
@@ -308,7 +421,7 @@ void print_env_var(const env_var_t *var, int first_colwidth, int second_colwidth
         }
     }
 
-    char *status;
+    char *status    = " ";
     char *statusclr = NO_COLOR;
 
     if (comparing) {
@@ -333,10 +446,17 @@ void print_env_var(const env_var_t *var, int first_colwidth, int second_colwidth
         }
     }
 
+    // schema violations get a marker column of their own, next to the
+    // comparison status
+    char *invalidmark = var->invalid ? "~" : " ";
+
     writef("  "); // leading spaces
     if (comparing) {
         writef("%s%s%s ", statusclr, status, NO_COLOR);
     }
+    if (validating) {
+        writef("%s%s%s ", ORANGE, invalidmark, NO_COLOR);
+    }
     writef("%s%-*.*s%s", keyclr, first_colwidth + 4, first_colwidth, var->name,
            NO_COLOR); // column 1
     writef("%s%-*.*s%s", val_a_clr, second_colwidth + 3, second_colwidth, __val_a,
@@ -345,18 +465,21 @@ void print_env_var(const env_var_t *var, int first_colwidth, int second_colwidth
         writef("%s%-*.*s%s", val_b_clr, third_colwidth, third_colwidth, __val_b,
                NO_COLOR); // column 3
     }
+    if (var->invalid) {
+        writef("  %s(expected %s)%s", ORANGE, schema_rule_desc(var->rule), NO_COLOR);
+    }
     writef("\n"); // line break
 }
 
 void create_env_var_from_line(hash_table_t *ht,
+                              trie_t       *trie,
                               const char   *line,
-                              const char  **ignorev,
-                              size_t        ignorec,
-                              const char  **focusv,
-                              size_t        focusc,
                               bool          comparing,
-                              bool          interpolate) {
+                              bool          interpolate,
+                              schema_t     *schema,
+                              bool          validate) {
     assert(ht != NULL);
+    assert(trie != NULL);
 
     if (!line) {
         return;
@@ -377,28 +500,6 @@ void create_env_var_from_line(hash_table_t *ht,
     strncpy(name, line, namelen);
     name[namelen] = '\0';
 
-    if (ignorec > 0) {
-        for (size_t i = 0; i < ignorec; i++) {
-            if (match_pattern(name, ignorev[i])) {
-                return;
-            }
-        }
-    }
-
-    if (focusc > 0) {
-        bool ignore = true;
-        for (size_t i = 0; i < focusc; i++) {
-            if (match_pattern(name, focusv[i])) {
-                ignore = false;
-                break;
-            }
-        }
-
-        if (ignore) {
-            return;
-        }
-    }
-
     size_t vallen = strlen(delimpos + 1);
     char  *value  = (char *) malloc((vallen + 1) * sizeof(char));
 
@@ -430,6 +531,9 @@ void create_env_var_from_line(hash_table_t *ht,
             var->cmpval    = value;
             var->cmpvallen = vallen;
 
+            if (validate) {
+                validate_env_var(var, value, vallen);
+            }
             set_env_var_status(var);
         }
 
@@ -464,12 +568,35 @@ void create_env_var_from_line(hash_table_t *ht,
         var->vallen     = comparing ? 0 : vallen;
         var->cmpvallen  = comparing ? vallen : 0;
         var->interpolated = interpolates;
+        var->invalid      = false;
+        var->rule         = schema_find(schema, name);
 
         ht_put(ht, name, var);
+
+        if (!trie_put(trie, var->name, var)) {
+            panic("Failed to allocate memory");
+            /* NOT REACHED */
+        }
+
+        if (validate) {
+            validate_env_var(var, value, vallen);
+        }
         set_env_var_status(var);
     }
 }
 
+// Checks a value against the precompiled rule attached to its variable while
+// the file is being parsed. Empty values are reported as missing and
+// references to other variables can't be judged before interpolation, so both
+// are skipped.
+void validate_env_var(env_var_t *var, const char *value, size_t vallen) {
+    if (var->rule == NULL || vallen == 0 || is_interpolated(value)) {
+        return;
+    }
+
+    var->invalid = !schema_rule_check(var->rule, value, vallen);
+}
+
 bool is_interpolated(const char *str) {
     if (str == NULL) {
         return false;
@@ -490,7 +617,8 @@ void interpolate_env_vars(hash_table_t *ht, const char **keyv, size_t keyc) {
             str_slice(var->val, 2, var->vallen - 1, buf);
             env_var_t *ref = ht_get(ht, buf);
             if (ref) {
-                var->val = ref->val ? strdup(ref->val) : NULL;
+                var->val    = ref->val ? strdup(ref->val) : NULL;
+                var->vallen = ref->val ? ref->vallen : 0;
             }
         }
         bool cmpval_is_interpolated = is_interpolated(var->cmpval);
@@ -499,12 +627,25 @@ void interpolate_env_vars(hash_table_t *ht, const char **keyv, size_t keyc) {
             str_slice(var->cmpval, 2, var->cmpvallen - 1, buf);
             env_var_t *ref = ht_get(ht, buf);
             if (ref) {
-                var->cmpval = ref->cmpval ? strdup(ref->cmpval) : NULL;
+                var->cmpval    = ref->cmpval ? strdup(ref->cmpval) : NULL;
+                var->cmpvallen = ref->cmpval ? ref->cmpvallen : 0;
             }
         }
     }
 }
 
+void handle_env_line(char *line, size_t len, void *ctx) {
+    (void) len;
+    env_file_ctx_t *file = ctx;
+    create_env_var_from_line(file->ht,
+                             file->trie,
+                             line,
+                             file->comparing,
+                             file->interpolate,
+                             file->schema,
+                             file->validate);
+}
+
 void set_env_var_status(env_var_t *var) {
     bool val_is_empty    = str_is_empty(var->val);
     bool cmpval_is_empty = str_is_empty(var->cmpval);
@@ -532,42 +673,34 @@ void set_env_var_status(env_var_t *var) {
 }
 
 int read_env_file(hash_table_t *ht,
+                  trie_t       *trie,
                   const char   *path,
-                  const char  **ignorev,
-                  size_t        ignorec,
-                  const char  **focusv,
-                  size_t        focusc,
                   bool          comparing,
-                  bool          interpolate) {
+                  bool          interpolate,
+                  schema_t     *schema,
+                  bool          validate) {
     assert(ht != NULL);
     assert(path != NULL);
 
-    if (!file_exists(path)) {
-        panicf("File '%s' does not exist", path);
-        /* NOT REACHED */
-    }
-
-    if (ignorec > 0 && focusc > 0) {
-        panic("Cannot read env file while taking both ignore and focus arguments");
-        /* NOT REACHED */
-    }
-
-    FILE   *file;
-    char   *buffer = NULL;
-    size_t  len    = 0;
-    ssize_t read;
-    file = fopen(path, "r");
+    env_file_ctx_t ctx = {
+        .ht          = ht,
+        .trie        = trie,
+        .comparing   = comparing,
+        .interpolate = interpolate,
+        .schema      = schema,
+        .validate    = validate,
+    };
+
+    if (reader_read_lines(path, handle_env_line, &ctx) != 0) {
+        if (errno == ENOENT) {
+            panicf("File '%s' does not exist", path);
+            /* NOT REACHED */
+        }
 
-    if (file == NULL) {
         panicf("Failed to read file '%s'", path);
         /* NOT REACHED */
     }
 
-    while ((read = getline(&buffer, &len, file)) != -1) {
-        create_env_var_from_line(ht, buffer, ignorev, ignorec, focusv, focusc, comparing, interpolate);
-    }
-
-    fclose(file);
     return EXIT_SUCCESS;
 }
 
@@ -593,6 +726,236 @@ bool match_pattern(const char *str, const char *pattern) {
     return false;
 }
 
+// Patterns like "DB_*" only constrain the start of a name.
+bool is_prefix_pattern(const char *pattern) {
+    size_t len = strlen(pattern);
+
+    if (len == 0 || pattern[len - 1] != '*') {
+        return false;
+    }
+
+    for (size_t i = 0; i + 1 < len; ++i) {
+        if (pattern[i] == '*' || pattern[i] == '?') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Prefix patterns are a plain compare instead of a walk through the glob
+// matcher.
+bool match_env_pattern(const char *name, size_t namelen, const char *pattern) {
+    if (is_prefix_pattern(pattern)) {
+        size_t prefixlen = strlen(pattern) - 1;
+        return namelen >= prefixlen && strncmp(name, pattern, prefixlen) == 0;
+    }
+
+    return match_pattern(name, pattern);
+}
+
+bool is_env_key_selected(const env_selection_t *selection, const char *key, size_t keylen) {
+    for (size_t i = 0; i < selection->patternc; ++i) {
+        if (match_env_pattern(key, keylen, selection->patternv[i])) {
+            return selection->focus;
+        }
+    }
+
+    return !selection->focus || selection->patternc == 0;
+}
+
+bool is_env_subtree_skipped(const env_selection_t *selection, const trie_node_t *node) {
+    for (size_t i = 0; i < selection->skipc; ++i) {
+        if (selection->skipv[i] == node) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool collect_env_key(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx) {
+    (void) depth;
+    env_key_walk_t *walk = ctx;
+
+    if (is_env_subtree_skipped(walk->selection, node)) {
+        return false;
+    }
+
+    if (node->value != NULL && is_env_key_selected(walk->selection, key, keylen)) {
+        env_var_t *var           = node->value;
+        walk->keyv[walk->keyc++] = var->name;
+    }
+
+    return true;
+}
+
+bool enter_env_group(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx) {
+    env_group_walk_t *walk = ctx;
+
+    if (is_env_subtree_skipped(walk->selection, node)) {
+        return false;
+    }
+
+    if (depth == walk->framecap) {
+        size_t             cap    = walk->framecap ? walk->framecap * 2 : 16;
+        env_group_frame_t *framev = realloc(walk->framev, cap * sizeof(*framev));
+
+        if (framev == NULL) {
+            panic("Failed to allocate memory");
+            /* NOT REACHED */
+        }
+
+        walk->framev   = framev;
+        walk->framecap = cap;
+    }
+
+    env_group_frame_t *frame = &walk->framev[depth];
+    memset(frame->counts, 0, sizeof(frame->counts));
+    frame->first  = walk->groupc;
+    frame->opened = 0;
+
+    if (node->value != NULL && is_env_key_selected(walk->selection, key, keylen)) {
+        env_var_t *var = node->value;
+        frame->counts[var->status] += 1;
+
+        if (var->invalid) {
+            frame->counts[ENV_GROUP_INVALID] += 1;
+        }
+    }
+
+    // every '_' closes a namespace segment, e.g. "AWS_" and "AWS_S3_", and an
+    // edge may hold several of them; none is opened above the walk's prefix
+    size_t from = keylen - node->edgelen;
+    if (walk->base > 0) {
+        from = max(from, walk->base - 1);
+    }
+
+    for (size_t i = from; i < keylen; ++i) {
+        if (key[i] != '_') {
+            continue;
+        }
+
+        if (walk->groupc == walk->groupcap) {
+            size_t       cap    = walk->groupcap ? walk->groupcap * 2 : 16;
+            env_group_t *groupv = realloc(walk->groupv, cap * sizeof(*groupv));
+
+            if (groupv == NULL) {
+                panic("Failed to allocate memory");
+                /* NOT REACHED */
+            }
+
+            walk->groupv   = groupv;
+            walk->groupcap = cap;
+        }
+
+        env_group_t *group = &walk->groupv[walk->groupc++];
+        group->prefix      = strndup(key, i + 1);
+        group->level       = walk->level++;
+
+        if (group->prefix == NULL) {
+            panic("Failed to allocate memory");
+            /* NOT REACHED */
+        }
+
+        frame->opened += 1;
+    }
+
+    return true;
+}
+
+// Rolls the counters of a subtree up into its parent, so each group is
+// counted once in a single traversal.
+void leave_env_group(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx) {
+    (void) node;
+    (void) key;
+    (void) keylen;
+    env_group_walk_t  *walk   = ctx;
+    env_group_frame_t *frame  = &walk->framev[depth];
+    size_t            *parent = depth > 0 ? walk->framev[depth - 1].counts : walk->total;
+
+    for (size_t i = 0; i < frame->opened; ++i) {
+        memcpy(walk->groupv[frame->first + i].counts, frame->counts, sizeof(frame->counts));
+    }
+    walk->level -= frame->opened;
+
+    for (size_t i = 0; i < ENV_GROUP_COUNTER_COUNT; ++i) {
+        parent[i] += frame->counts[i];
+    }
+}
+
+// The INVALID column is only shown when a schema was loaded.
+void print_env_groups(const env_group_walk_t *walk, bool comparing, bool validating) {
+    const char *labelv[ENV_GROUP_COUNTER_COUNT] = {"OK", "MISSING", "DIVERGENT", "UNDEFINED", "INVALID"};
+    const char *colorv[ENV_GROUP_COUNTER_COUNT] = {NO_COLOR, RED_BOLD, YELLOW_BOLD, MAGENTA_LIGHT, ORANGE};
+    const char *totallabel                      = "(total)";
+    size_t      colwidth                        = strlen(totallabel);
+    size_t      totals[max(walk->groupc, 1)];
+
+    for (size_t i = 0; i < walk->groupc; ++i) {
+        const env_group_t *group = &walk->groupv[i];
+
+        totals[i] = 0;
+        for (size_t j = 0; j < ENV_VAR_STATUS_COUNT; ++j) {
+            totals[i] += group->counts[j];
+        }
+
+        if (totals[i] >= ENV_GROUP_MIN_SIZE) {
+            colwidth = max(colwidth, group->level * 2 + strlen(group->prefix));
+        }
+    }
+
+    writef("  %s%-*s%s", WHITE_BOLD, (int) colwidth + 2, "GROUP", NO_COLOR);
+    if (comparing) {
+        for (size_t j = 0; j < ENV_VAR_STATUS_COUNT; ++j) {
+            writef("%s%*s%s", colorv[j], (int) strlen(labelv[j]) + 2, labelv[j], NO_COLOR);
+        }
+    } else {
+        writef("%*s", 7, "COUNT");
+    }
+    if (validating) {
+        writef("%s%*s%s", colorv[ENV_GROUP_INVALID], (int) strlen(labelv[ENV_GROUP_INVALID]) + 2, labelv[ENV_GROUP_INVALID], NO_COLOR);
+    }
+    writef("\n");
+
+    for (size_t i = 0; i <= walk->groupc; ++i) {
+        bool          is_total = i == walk->groupc;
+        const size_t *counts   = is_total ? walk->total : walk->groupv[i].counts;
+        size_t        level    = is_total ? 0 : walk->groupv[i].level;
+        const char   *prefix   = is_total ? totallabel : walk->groupv[i].prefix;
+
+        if (!is_total && totals[i] < ENV_GROUP_MIN_SIZE) {
+            continue;
+        }
+
+        writef("  %*s%s%-*s%s", (int) level * 2, "", WHITE_BOLD, (int) (colwidth - level * 2) + 2, prefix, NO_COLOR);
+
+        if (comparing) {
+            for (size_t j = 0; j < ENV_VAR_STATUS_COUNT; ++j) {
+                writef("%s%*zu%s",
+                       counts[j] > 0 ? colorv[j] : DARK_GRAY,
+                       (int) strlen(labelv[j]) + 2,
+                       counts[j],
+                       NO_COLOR);
+            }
+        } else {
+            size_t count = 0;
+            for (size_t j = 0; j < ENV_VAR_STATUS_COUNT; ++j) {
+                count += counts[j];
+            }
+            writef("%7zu", count);
+        }
+        if (validating) {
+            writef("%s%*zu%s",
+                   counts[ENV_GROUP_INVALID] > 0 ? colorv[ENV_GROUP_INVALID] : DARK_GRAY,
+                   (int) strlen(labelv[ENV_GROUP_INVALID]) + 2,
+                   counts[ENV_GROUP_INVALID],
+                   NO_COLOR);
+        }
+        writef("\n");
+    }
+}
+
 void print_title(const char *filename) {
     if (filename == NULL) {
         return;
@@ -619,17 +982,48 @@ int handle_cmd(command_t *self) {
     char *ignore       = get_string_opt(self, "ignore");
     char *key          = get_string_opt(self, "key");
     char *truncate     = get_string_opt(self, "truncate");
+    char *schemapath   = get_string_opt(self, "schema");
     bool  missing      = get_bool_opt(self, "missing");
     bool  undefined    = get_bool_opt(self, "undefined");
     bool  divergent    = get_bool_opt(self, "divergent");
-    bool  interpolate    = get_bool_opt(self, "interpolate");
+    bool  interpolate  = get_bool_opt(self, "interpolate");
+    bool  group        = get_bool_opt(self, "group");
+    bool  invalid      = get_bool_opt(self, "invalid");
 
     int   truncate_val = truncate ? atoi(truncate) : 0;
     if (truncate_val > 0) {
         truncate_val = max(truncate_val, 7);
     }
-    bool   selective = missing || undefined || divergent;
-    bool   comparing = source != NULL;
+    bool   selective  = missing || undefined || divergent || invalid;
+    bool   comparing  = source != NULL;
+    bool   validating = schemapath != NULL;
+
+    if (comparing && reader_is_stdin(source) && reader_is_stdin(target)) {
+        panic("Cannot read both the source and the target from stdin");
+        /* NOT REACHED */
+    }
+
+    if (validating && reader_is_stdin(schemapath) && (reader_is_stdin(target) || reader_is_stdin(source))) {
+        panic("Cannot read both the schema and an env file from stdin");
+        /* NOT REACHED */
+    }
+
+    if (invalid && !validating) {
+        panic("Cannot show invalid variables without a schema");
+        /* NOT REACHED */
+    }
+
+    // compiled once, before any env file is parsed
+    schema_t *schema = NULL;
+    if (validating) {
+        char errbuf[SCHEMA_ERR_SIZE];
+        schema = schema_load(schemapath, errbuf);
+
+        if (schema == NULL) {
+            panicf("Invalid schema '%s': %s", schemapath, errbuf);
+            /* NOT REACHED */
+        }
+    }
 
     size_t ignorec   = ignore ? str_count_char(ignore, ',') + 1 : 0;
     char  *ignorev[ignorec];
@@ -639,38 +1033,94 @@ int handle_cmd(command_t *self) {
     char  *focusv[focusc];
     str_split_by_delim(key, ',', focusv, focusc);
 
-    hash_table_t ht = ht_create(50);
+    if (ignorec > 0 && focusc > 0) {
+        panic("Cannot read env file while taking both ignore and focus arguments");
+        /* NOT REACHED */
+    }
+
+    hash_table_t ht   = ht_create(50);
+    trie_t       trie = trie_create();
 
-    if (comparing &&
-        read_env_file(&ht, source, (const char **) ignorev, ignorec, (const char **) focusv, focusc, false, interpolate) >
-            0) {
+    // both files attach the schema rules to the keys they create, only the
+    // target values are validated
+    if (comparing && read_env_file(&ht, &trie, source, false, interpolate, schema, false) > 0) {
         free_strings(ignorev, ignorec);
         free_strings(focusv, focusc);
+        trie_free(&trie);
         ht_free(&ht);
+        schema_free(schema);
         return EXIT_FAILURE;
     }
 
-    if (read_env_file(&ht,
-                      target,
-                      (const char **) ignorev,
-                      ignorec,
-                      (const char **) focusv,
-                      focusc,
-                      comparing,
-                      interpolate) > 0) {
+    if (read_env_file(&ht, &trie, target, comparing, interpolate, schema, true) > 0) {
         free_strings(ignorev, ignorec);
         free_strings(focusv, focusc);
+        trie_free(&trie);
         ht_free(&ht);
+        schema_free(schema);
         return EXIT_FAILURE;
     }
 
-    free_strings(ignorev, ignorec);
-    free_strings(focusv, focusc);
+    // every variable is stored, so references resolve the same whichever
+    // patterns were given; the selection is applied to the trie afterwards
+    trie_node_t    *skipv[max(ignorec, 1)];
+    const char     *patternv[max(ignorec + focusc, 1)];
+    env_selection_t selection = {.skipv = skipv, .skipc = 0, .patternv = patternv, .patternc = 0, .focus = focusc > 0};
+
+    for (size_t i = 0; i < ignorec; ++i) {
+        if (!is_prefix_pattern(ignorev[i])) {
+            patternv[selection.patternc++] = ignorev[i];
+            continue;
+        }
+
+        ignorev[i][strlen(ignorev[i]) - 1] = '\0'; // drop the trailing '*'
+        trie_node_t *node                  = trie_find_prefix(&trie, ignorev[i]);
+
+        if (node != NULL) {
+            skipv[selection.skipc++] = node;
+        }
+    }
+
+    bool prefix_focus = focusc > 0;
+    for (size_t i = 0; i < focusc && prefix_focus; ++i) {
+        prefix_focus = is_prefix_pattern(focusv[i]);
+    }
 
-    size_t      vars = ht.size;
-    const char *keys[vars];
-    ht_keys(&ht, keys, vars);
-    sort_env_vars_array(keys, vars);
+    // walk only the focused subtrees, in order and without overlap, so the
+    // keys come out sorted
+    size_t      rootc = 0;
+    const char *rootv[max(focusc, 1)];
+    if (prefix_focus) {
+        const char *prefixv[focusc];
+        for (size_t i = 0; i < focusc; ++i) {
+            focusv[i][strlen(focusv[i]) - 1] = '\0'; // drop the trailing '*'
+            prefixv[i]                       = focusv[i];
+        }
+        sort_env_vars_array(prefixv, focusc);
+
+        for (size_t i = 0; i < focusc; ++i) {
+            if (rootc == 0 || !str_starts_with(prefixv[i], rootv[rootc - 1])) {
+                rootv[rootc++] = prefixv[i];
+            }
+        }
+    } else {
+        rootv[rootc++] = "";
+
+        for (size_t i = 0; i < focusc; ++i) {
+            patternv[selection.patternc++] = focusv[i];
+        }
+    }
+
+    size_t         vars = ht.size;
+    const char    *keys[max(vars, 1)];
+    env_key_walk_t keywalk = {.selection = &selection, .keyv = keys, .keyc = 0};
+    for (size_t i = 0; i < rootc; ++i) {
+        if (!trie_walk(&trie, rootv[i], collect_env_key, NULL, &keywalk)) {
+            panic("Failed to allocate memory");
+            /* NOT REACHED */
+        }
+    }
+    vars = keywalk.keyc;
 
     if (interpolate) {
         interpolate_env_vars(&ht, keys, vars);
@@ -684,6 +1134,42 @@ int handle_cmd(command_t *self) {
         print_title(target);
     }
 
+    if (group) {
+        env_group_walk_t groupwalk = {.selection = &selection,
+                                      .base      = 0,
+                                      .groupv    = NULL,
+                                      .groupc    = 0,
+                                      .groupcap  = 0,
+                                      .framev    = NULL,
+                                      .framecap  = 0,
+                                      .level     = 0,
+                                      .total     = {0}};
+
+        for (size_t i = 0; i < rootc; ++i) {
+            groupwalk.base = strlen(rootv[i]);
+
+            if (!trie_walk(&trie, rootv[i], enter_env_group, leave_env_group, &groupwalk)) {
+                panic("Failed to allocate memory");
+                /* NOT REACHED */
+            }
+        }
+
+        print_env_groups(&groupwalk, comparing, validating);
+
+        for (size_t i = 0; i < groupwalk.groupc; ++i) {
+            free(groupwalk.groupv[i].prefix);
+        }
+        free(groupwalk.groupv);
+        free(groupwalk.framev);
+        free_strings(ignorev, ignorec);
+        free_strings(focusv, focusc);
+        trie_free(&trie);
+        ht_free(&ht);
+        schema_free(schema);
+
+        return EXIT_SUCCESS;
+    }
+
     size_t first_colwidth  = 7;
     size_t second_colwidth = 7;
     size_t third_colwidth  = 7;
@@ -691,7 +1177,8 @@ int handle_cmd(command_t *self) {
     for (size_t i = 0; i < vars; ++i) {
         env_var_t *var          = ht_get(&ht, keys[i]);
         bool       should_print = !selective || (var->status == MISSING && missing) ||
-                            (var->status == UNDEFINED && undefined) || (var->status == DIVERGENT && divergent);
+                            (var->status == UNDEFINED && undefined) || (var->status == DIVERGENT && divergent) ||
+                            (var->invalid && invalid);
 
         if (!should_print) {
             continue;
@@ -710,14 +1197,20 @@ int handle_cmd(command_t *self) {
     for (size_t i = 0; i < vars; ++i) {
         env_var_t *var          = ht_get(&ht, keys[i]);
         bool       should_print = !selective || (var->status == MISSING && missing) ||
-                            (var->status == UNDEFINED && undefined) || (var->status == DIVERGENT && divergent);
+                            (var->status == UNDEFINED && undefined) || (var->status == DIVERGENT && divergent) ||
+                            (var->invalid && invalid);
 
         if (should_print) {
-            print_env_var(var, (int) first_colwidth, (int) second_colwidth, (int) third_colwidth, comparing);
+            print_env_var(
+                var, (int) first_colwidth, (int) second_colwidth, (int) third_colwidth, comparing, validating);
         }
     }
 
+    free_strings(ignorev, ignorec);
+    free_strings(focusv, focusc);
+    trie_free(&trie);
     ht_free(&ht);
+    schema_free(schema);
 
     return EXIT_SUCCESS;
 }
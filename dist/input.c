@@ -11,7 +11,8 @@
 
 #define ARG_PARSER_ERR_SIZE 1024
 
-static int handle_opt_value(option_t *opt, char *name, char *value, input_parser_t *parser);
+static int       handle_opt_value(option_t *opt, const char *name, size_t len, char *value, input_parser_t *parser);
+static option_t *find_cmd_opt(command_t *cmd, const char *name);
 
 // ==== Implementations =======================================================/
 input_parser_t
@@ -24,6 +25,7 @@ input_parser_create(argument_t **argv, size_t argc, option_t **optv, size_t optc
         .optv   = optv,
         .optc   = optc,
         .parsed = 0,
+        .index  = NULL,
     };
 
     return parser;
@@ -37,7 +39,7 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
         char *current_arg = argv[i];
         parser->parsed += 1;
 
-        if (str_equals(current_arg, "--")) {
+        if (current_arg[0] == '-' && current_arg[1] == '-' && current_arg[2] == '\0') {
             parsing_args = true;
             continue;
         }
@@ -59,22 +61,18 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
                 return;
             }
 
-            // sanitize name (remove leading hyphens)
-            int  offset = is_long_opt ? 2 : 1;
-            int  len    = strlen(current_arg);
-            char sanitized[len];
-            strncpy(sanitized, current_arg + offset, len);
-
             if (is_short_opt) {
-                int shortlen = len - offset;
+                // name without the leading hyphen
+                char  *name     = current_arg + 1;
+                size_t shortlen = strlen(name);
 
                 // chained short options
                 // currently short options with a value expect a space
                 if (shortlen == 1) {
-                    option_t *opt = option_find(parser->optv, parser->optc, NULL, sanitized);
+                    option_t *opt = option_index_find_by_shortcut(parser->index, parser->optv, parser->optc, name[0]);
 
                     if (!opt) {
-                        sprintf(parser->errbuf, "Received unknown option: %s", sanitized);
+                        sprintf(parser->errbuf, "Received unknown option: %s", name);
                         return;
                     }
 
@@ -85,12 +83,13 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
                         ++i;
                     }
 
-                    if (handle_opt_value(opt, sanitized, value, parser) > 0) {
+                    if (handle_opt_value(opt, name, shortlen, value, parser) > 0) {
                         return;
                     }
                 } else {
-                    for (int j = 0; j < shortlen; j++) {
-                        option_t *opt = option_find_by_shortcut(parser->optv, parser->optc, sanitized[j]);
+                    for (size_t j = 0; j < shortlen; j++) {
+                        option_t *opt =
+                            option_index_find_by_shortcut(parser->index, parser->optv, parser->optc, name[j]);
                         if (opt) {
                             if (option_is_level(opt)) {
                                 opt->levelval = min(opt->levelval + 1, OPTION_MAX_LEVEL);
@@ -100,7 +99,7 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
 
                             opt->provided = true;
                         } else {
-                            sprintf(parser->errbuf, "Received unknown option: %c", sanitized[j]);
+                            sprintf(parser->errbuf, "Received unknown option: %c", name[j]);
                             return;
                         }
                     }
@@ -109,20 +108,17 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
                 continue;
             }
 
-            // extract value from option, if given
-            char *name  = NULL;
-            char *value = NULL;
-            if (strchr(sanitized, '=') != NULL) {
-                name  = strtok(sanitized, "=");
-                value = strtok(NULL, "=");
-            } else {
-                name = sanitized;
-            }
+            // extract value from option, if given; both point into argv, so
+            // nothing needs to be copied
+            char  *name    = current_arg + 2;
+            char  *delim   = strchr(name, '=');
+            size_t namelen = delim ? (size_t) (delim - name) : strlen(name);
+            char  *value   = delim && delim[1] != '\0' ? delim + 1 : NULL;
 
-            option_t *current_opt = option_find_by_long_name(parser->optv, parser->optc, name);
+            option_t *current_opt = option_index_find(parser->index, parser->optv, parser->optc, name, namelen);
 
             if (current_opt == NULL) {
-                sprintf(parser->errbuf, "Received unknown option: %s", name);
+                sprintf(parser->errbuf, "Received unknown option: %.*s", (int) namelen, name);
                 return;
             }
 
@@ -130,7 +126,7 @@ void input_parse(input_parser_t *parser, int argc, char **argv) {
                 value = i + 1 < argc ? argv[++i] : NULL;
             }
 
-            if (handle_opt_value(current_opt, name, value, parser) > 0) {
+            if (handle_opt_value(current_opt, name, namelen, value, parser) > 0) {
                 return;
             }
         } else {
@@ -202,39 +198,40 @@ char *get_arg(command_t *cmd, const char *name) {
 }
 
 bool get_bool_opt(command_t *cmd, const char *name) {
-    option_t *opt = option_find(cmd->optv, cmd->optc, name, NULL);
+    option_t *opt = find_cmd_opt(cmd, name);
     return opt ? opt->boolval : false;
 }
 
 char *get_string_opt(command_t *cmd, const char *name) {
-    option_t *opt = option_find(cmd->optv, cmd->optc, name, NULL);
+    option_t *opt = find_cmd_opt(cmd, name);
     return opt ? opt->stringval : NULL;
 }
 
 char **get_string_array_opt(command_t *cmd, const char *name) {
-    option_t *opt = option_find(cmd->optv, cmd->optc, name, NULL);
+    option_t *opt = find_cmd_opt(cmd, name);
     return opt ? opt->stringv : NULL;
 }
 
-static int handle_opt_value(option_t *opt, char *name, char *value, input_parser_t *parser) {
+static option_t *find_cmd_opt(command_t *cmd, const char *name) {
+    return option_index_find(&cmd->__index, cmd->optv, cmd->optc, name, strlen(name));
+}
+
+// Values are not copied: they point into argv, which outlives the command.
+static int handle_opt_value(option_t *opt, const char *name, size_t len, char *value, input_parser_t *parser) {
     opt->provided = true;
 
     if (option_is_level(opt)) {
         opt->levelval = min(opt->levelval + 1, OPTION_MAX_LEVEL);
     } else if (option_is_bool(opt) && !value) {
-        if (option_is_negatable(opt) && str_starts_with(name, "no-")) {
+        if (option_is_negatable(opt) && len > 3 && strncmp(name, "no-", 3) == 0) {
             opt->boolval = false;
         } else {
             opt->boolval = true;
         }
     } else if (option_expects_value(opt) && !value) {
-        sprintf(parser->errbuf, "Missing required value for option %s", name);
+        sprintf(parser->errbuf, "Missing required value for option %.*s", (int) len, name);
         return 1;
     } else if (option_has_value(opt) && value) {
-        char *p = malloc(sizeof(char) * (strlen(value) + 1));
-        assert(p != NULL);
-        strcpy(p, value);
-
         if (option_is_array(opt)) {
             size_t newCount = opt->stringc + 1;
             if (!opt->stringv) {
@@ -245,11 +242,10 @@ static int handle_opt_value(option_t *opt, char *name, char *value, input_parser
 
             assert(opt->stringv != NULL);
             opt->stringc               = newCount;
-            opt->stringv[newCount - 1] = p;
+            opt->stringv[newCount - 1] = value;
             opt->__meta |= OPTION_META_CLEANUP_VALUE_ARRAY;
         } else {
-            opt->stringval = p;
-            opt->__meta |= OPTION_META_CLEANUP_VALUE;
+            opt->stringval = value;
         }
     }
 
@@ -6,13 +6,14 @@
 #include <option.h>
 
 typedef struct InputParser {
-    option_t   **optv;
-    size_t       optc;
-    argument_t **argv;
-    size_t       argc;
-    unsigned int offset;
-    char        *errbuf;
-    unsigned int parsed;
+    option_t            **optv;
+    size_t                optc;
+    argument_t          **argv;
+    size_t                argc;
+    unsigned int          offset;
+    char                 *errbuf;
+    unsigned int          parsed;
+    const option_index_t *index;
 } input_parser_t;
 
 void input_parse(input_parser_t *parser, int argc, char **argv);
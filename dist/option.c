@@ -6,6 +6,11 @@
 #include <option.h>
 #include <output.h>
 #include <string.h>
+#include <strings.h>
+
+static unsigned int option_hash(const char *name, size_t len, unsigned int seed);
+static bool         option_name_equals(const char *name, const char *input, size_t len);
+static option_t    *option_index_find_exact(const option_index_t *index, option_t **optv, const char *name, size_t len);
 
 // ==== Implementations =======================================================/
 void option_init(option_t *opt, const char *name, const char *shortcut, const char *desc) {
@@ -133,6 +138,150 @@ int option_index_of(option_t **optv, size_t optc, const char *name, const char *
     return -1;
 }
 
+// Fills the index of a table with the seed hard-coded next to its declaration.
+// If the table changed and the seed no longer maps every long name to its own
+// slot, debug builds report the seed to use instead, release builds fall back
+// to scanning the table.
+void option_index_build(option_index_t *index, option_t **optv, size_t optc, unsigned int seed) {
+    assert(index != NULL);
+
+    index->built = false;
+    index->seed  = seed;
+    memset(index->shortv, 0, sizeof(index->shortv));
+    memset(index->longv, 0, sizeof(index->longv));
+
+    if (optc > OPTION_INDEX_SIZE / 2) {
+        panicf("Option table of %zu options doesn't fit the index", optc);
+        /* NOT REACHED */
+    }
+
+    // walk backwards, so the first option wins a shared shortcut
+    for (size_t i = optc; i > 0; --i) {
+        option_t *opt = optv[i - 1];
+        assert(opt != NULL);
+
+        if (opt->shortcut && (unsigned char) opt->shortcut[0] < sizeof(index->shortv)) {
+            index->shortv[(unsigned char) opt->shortcut[0]] = (unsigned char) i;
+        }
+    }
+
+    for (size_t i = 0; i < optc; ++i) {
+        const char  *name = optv[i]->name;
+        unsigned int slot = option_hash(name, strlen(name), seed) & (OPTION_INDEX_SIZE - 1);
+
+        if (index->longv[slot] != 0) {
+            panicf("Option index seed %u collides, use %d", seed, option_index_seed(optv, optc));
+            /* NOT REACHED */
+        }
+
+        index->longv[slot] = (unsigned char) (i + 1);
+    }
+
+    index->built = true;
+}
+
+// Whether `seed` maps every long name of the table to its own slot.
+bool option_index_fits(option_t **optv, size_t optc, unsigned int seed) {
+    if (optc > OPTION_INDEX_SIZE / 2) {
+        return false;
+    }
+
+    unsigned char usedv[OPTION_INDEX_SIZE] = {0};
+
+    for (size_t i = 0; i < optc; ++i) {
+        const char  *name = optv[i]->name;
+        unsigned int slot = option_hash(name, strlen(name), seed) & (OPTION_INDEX_SIZE - 1);
+
+        if (usedv[slot] != 0) {
+            return false;
+        }
+
+        usedv[slot] = 1;
+    }
+
+    return true;
+}
+
+// Searches the first seed that fits the table, or -1 if there is none. Only
+// used to find the seeds that get hard-coded next to the static tables, never
+// on the parse path.
+int option_index_seed(option_t **optv, size_t optc) {
+    for (unsigned int seed = 0; seed < OPTION_INDEX_SEEDS; ++seed) {
+        if (option_index_fits(optv, optc, seed)) {
+            return (int) seed;
+        }
+    }
+
+    return -1;
+}
+
+// Finds an option by the first `len` chars of `name`, which doesn't have to be
+// NUL terminated (e.g. "name" in "name=value"). Also resolves "no-name" for
+// negatable options, where the "no-" itself is case sensitive.
+option_t *option_index_find(const option_index_t *index, option_t **optv, size_t optc, const char *name, size_t len) {
+    assert(name != NULL);
+
+    if (index == NULL || !index->built) {
+        char buf[len + 1];
+        memcpy(buf, name, len);
+        buf[len] = '\0';
+        return option_find(optv, optc, buf, NULL);
+    }
+
+    option_t *opt = option_index_find_exact(index, optv, name, len);
+
+    if (opt == NULL && len > 3 && strncmp(name, "no-", 3) == 0) {
+        opt = option_index_find_exact(index, optv, name + 3, len - 3);
+
+        if (opt != NULL && !option_is_negatable(opt)) {
+            opt = NULL;
+        }
+    }
+
+    return opt;
+}
+
+option_t *option_index_find_by_shortcut(const option_index_t *index, option_t **optv, size_t optc, char shortcut) {
+    if (index == NULL || !index->built) {
+        return option_find_by_shortcut(optv, optc, shortcut);
+    }
+
+    if ((unsigned char) shortcut >= sizeof(index->shortv)) {
+        return NULL;
+    }
+
+    unsigned char i = index->shortv[(unsigned char) shortcut];
+    return i == 0 ? NULL : optv[i - 1];
+}
+
+static option_t *option_index_find_exact(const option_index_t *index, option_t **optv, const char *name, size_t len) {
+    unsigned int  slot = option_hash(name, len, index->seed) & (OPTION_INDEX_SIZE - 1);
+    unsigned char i    = index->longv[slot];
+
+    if (i == 0 || !option_name_equals(optv[i - 1]->name, name, len)) {
+        return NULL;
+    }
+
+    return optv[i - 1];
+}
+
+// FNV-1a over the lowercased name, as long names match case insensitively.
+static unsigned int option_hash(const char *name, size_t len, unsigned int seed) {
+    unsigned int hash = 2166136261u ^ (seed * 16777619u);
+
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char) name[i];
+        hash ^= (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        hash *= 16777619u;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+static bool option_name_equals(const char *name, const char *input, size_t len) {
+    return strncasecmp(name, input, len) == 0 && name[len] == '\0';
+}
+
 bool option_get_bool(option_t **optv, size_t optc, const char *name) {
     option_t *opt = option_find(optv, optc, name, NULL);
     return opt ? opt->boolval : false;
@@ -295,23 +444,11 @@ void option_sort(option_t **optv, size_t optc) {
 
 bool option_is_short(const char *name) {
     assert(name != NULL);
-    size_t len = strlen(name);
-
-    if (len < 2) {
-        return false;
-    }
-
     return name[0] == '-' && ((name[1] >= 'a' && name[1] <= 'z') || (name[1] >= 'A' && name[1] <= 'Z'));
 }
 
 bool option_is_long(const char *name) {
     assert(name != NULL);
-    size_t len = strlen(name);
-
-    if (len < 3) {
-        return false;
-    }
-
     return name[0] == '-' && name[1] == '-' &&
            ((name[2] >= 'a' && name[2] <= 'z') || (name[2] >= 'A' && name[2] <= 'Z'));
 }
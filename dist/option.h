@@ -4,7 +4,22 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-#define OPTION_MAX_LEVEL 3
+#define OPTION_MAX_LEVEL  3
+
+// Slots in the long name table of an option index, must be a power of two.
+#define OPTION_INDEX_SIZE 64
+// Number of hash seeds tried when searching a seed for a table.
+#define OPTION_INDEX_SEEDS 256
+
+// Static initializers, so option tables can be declared at compile time.
+#define OPTION(__name, __shortcut, __desc, __flags)                                                                    \
+    { .name = __name, .shortcut = __shortcut, .desc = __desc, .__flag = __flags }
+#define OPTION_BOOL(__name, __shortcut, __desc) OPTION(__name, __shortcut, __desc, OPTION_NO_VALUE)
+#define OPTION_STRING(__name, __shortcut, __desc, __defval, __required)                                                \
+    {                                                                                                                  \
+        .name = __name, .shortcut = __shortcut, .desc = __desc, .stringval = __defval,                                 \
+        .__flag = (__required) ? OPTION_VALUE_REQUIRED : OPTION_VALUE_OPTIONAL,                                        \
+    }
 
 typedef enum OptionFlag {
     OPTION_NO_VALUE        = 1 << 0,
@@ -16,9 +31,7 @@ typedef enum OptionFlag {
 } option_flag_t;
 
 typedef enum OptionMetaFlag {
-    OPTION_META_CLEANUP_OPT         = 1 << 0,
-    OPTION_META_CLEANUP_VALUE       = 1 << 1,
-    OPTION_META_CLEANUP_VALUE_ARRAY = 1 << 2,
+    OPTION_META_CLEANUP_VALUE_ARRAY = 1 << 0,
 } option_meta_flag_t;
 
 typedef struct option_t {
@@ -35,6 +48,16 @@ typedef struct option_t {
     int         __meta;
 } option_t;
 
+// Perfect hash of the long names (and a direct table of the shortcuts) of an
+// option table. The seed is precomputed per table, so building it is a single
+// pass and lookups don't scan every option.
+typedef struct OptionIndex {
+    bool          built;
+    unsigned int  seed;
+    unsigned char longv[OPTION_INDEX_SIZE]; // option index + 1, 0 if empty
+    unsigned char shortv[128];              // option index + 1, 0 if empty
+} option_index_t;
+
 void     option_init(option_t *opt, const char *name, const char *shortcut, const char *desc);
 option_t option_create(const char *name, const char *shortcut, const char *desc);
 option_t
@@ -47,6 +70,11 @@ int       option_index_of(option_t **optv, size_t optsc, const char *name, const
 option_t *option_find(option_t **optv, size_t optc, const char *name, const char *shortcut);
 option_t *option_find_by_shortcut(option_t **optv, size_t optc, char shortcut);
 option_t *option_find_by_long_name(option_t **optv, size_t optc, const char *name);
+void      option_index_build(option_index_t *index, option_t **optv, size_t optc, unsigned int seed);
+bool      option_index_fits(option_t **optv, size_t optc, unsigned int seed);
+int       option_index_seed(option_t **optv, size_t optc);
+option_t *option_index_find(const option_index_t *index, option_t **optv, size_t optc, const char *name, size_t len);
+option_t *option_index_find_by_shortcut(const option_index_t *index, option_t **optv, size_t optc, char shortcut);
 bool      option_get_bool(option_t **optv, size_t optc, const char *name);
 char     *option_get_string(option_t **optv, size_t optc, const char *name);
 char    **option_get_strings(option_t **optv, size_t optc, const char *name);
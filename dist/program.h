@@ -3,6 +3,9 @@
 
 #include <command.h>
 
+// Static initializer, extra fields (e.g. .cmdv, .art) may follow the version.
+#define PROGRAM(__name, __version, ...) { .name = __name, .version = __version, __VA_ARGS__ }
+
 typedef struct program_t {
     const char  *name;
     const char  *version;
@@ -0,0 +1,317 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math-utils.h>
+#include <pthread.h>
+#include <reader.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+typedef struct LineSplitter {
+    line_handler_func *handler;
+    void              *ctx;
+    char              *carry;
+    size_t             carrylen;
+    size_t             carrycap;
+} line_splitter_t;
+
+typedef struct ReaderSlot {
+    char  *data;
+    size_t len;
+    bool   full;
+} reader_slot_t;
+
+typedef struct Reader {
+    int             fd;
+    reader_slot_t   slots[2];
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    bool            done;
+    int             err;
+} reader_t;
+
+static ssize_t reader_fill(int fd, char *buf, size_t cap);
+static int     reader_consume(int fd, char *buf, line_splitter_t *splitter);
+static int     reader_stream(int fd, char *first, line_splitter_t *splitter);
+static void   *reader_run(void *arg);
+static bool    splitter_carry(line_splitter_t *splitter, const char *data, size_t len);
+static int     splitter_feed(line_splitter_t *splitter, char *data, size_t len);
+static void    splitter_finish(line_splitter_t *splitter);
+
+// ==== Implementations =======================================================/
+bool reader_is_stdin(const char *path) {
+    return path != NULL && strcmp(path, READER_STDIN_PATH) == 0;
+}
+
+// Reads `path` (or stdin for "-") line by line without requiring a regular,
+// seekable file, so pipes, FIFOs and process substitutions work too. Lines are
+// passed to `handler` NUL terminated and without their trailing '\n'. Returns 0
+// on success, or -1 with errno set if the input could not be opened or read.
+int reader_read_lines(const char *path, line_handler_func *handler, void *ctx) {
+    assert(path != NULL);
+    assert(handler != NULL);
+
+    bool use_stdin = reader_is_stdin(path);
+    int  fd        = use_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    char *first = malloc(READER_BUFFER_SIZE);
+
+    if (first == NULL) {
+        if (!use_stdin) {
+            close(fd);
+        }
+        errno = ENOMEM;
+        return -1;
+    }
+
+    line_splitter_t splitter = {.handler = handler, .ctx = ctx, .carry = NULL, .carrylen = 0, .carrycap = 0};
+    int             code     = 0;
+    ssize_t         n        = reader_fill(fd, first, READER_BUFFER_SIZE);
+
+    if (n < 0) {
+        code = -1;
+    } else if ((size_t) n < READER_BUFFER_SIZE) {
+        // the whole input fits in a single chunk, a reader thread would only
+        // add startup overhead
+        code = splitter_feed(&splitter, first, n);
+    } else {
+        code = reader_stream(fd, first, &splitter);
+    }
+
+    int err = errno;
+
+    if (code == 0) {
+        splitter_finish(&splitter);
+    } else {
+        free(splitter.carry);
+    }
+
+    free(first);
+    if (!use_stdin) {
+        close(fd);
+    }
+
+    errno = err;
+    return code;
+}
+
+// Reads until `cap` bytes are buffered or the input is exhausted. Pipes hand
+// out data in small pieces, so a single read() is not enough to fill a chunk.
+static ssize_t reader_fill(int fd, char *buf, size_t cap) {
+    size_t len = 0;
+
+    while (len < cap) {
+        ssize_t n = read(fd, buf + len, cap - len);
+
+        if (n == 0) {
+            break;
+        }
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        len += n;
+    }
+
+    return len;
+}
+
+static int reader_consume(int fd, char *buf, line_splitter_t *splitter) {
+    for (;;) {
+        ssize_t n = reader_fill(fd, buf, READER_BUFFER_SIZE);
+
+        if (n < 0 || splitter_feed(splitter, buf, n) < 0) {
+            return -1;
+        }
+
+        if ((size_t) n < READER_BUFFER_SIZE) {
+            return 0;
+        }
+    }
+}
+
+// Double buffered streaming: a reader thread fills one chunk while the caller
+// splits and handles the lines of the other.
+static int reader_stream(int fd, char *first, line_splitter_t *splitter) {
+    char *second = malloc(READER_BUFFER_SIZE);
+
+    if (second == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    reader_t reader = {
+        .fd    = fd,
+        .slots = {{.data = first, .len = READER_BUFFER_SIZE, .full = true}, {.data = second, .len = 0, .full = false}},
+        .done  = false,
+        .err   = 0,
+    };
+    pthread_mutex_init(&reader.lock, NULL);
+    pthread_cond_init(&reader.cond, NULL);
+
+    pthread_t thread;
+    int       code = 0;
+
+    if (pthread_create(&thread, NULL, reader_run, &reader) != 0) {
+        // no thread available, fall back to reading and parsing in turn
+        code = splitter_feed(splitter, first, READER_BUFFER_SIZE) < 0 ? -1 : reader_consume(fd, second, splitter);
+    } else {
+        for (size_t i = 0;; i ^= 1) {
+            reader_slot_t *slot = &reader.slots[i];
+
+            pthread_mutex_lock(&reader.lock);
+            while (!slot->full && !reader.done) {
+                pthread_cond_wait(&reader.cond, &reader.lock);
+            }
+            bool ready = slot->full;
+            pthread_mutex_unlock(&reader.lock);
+
+            if (!ready) {
+                break;
+            }
+
+            int fed = splitter_feed(splitter, slot->data, slot->len);
+
+            pthread_mutex_lock(&reader.lock);
+            slot->full = false;
+            if (fed < 0) {
+                reader.done = true;
+                reader.err  = errno;
+            }
+            pthread_cond_broadcast(&reader.cond);
+            pthread_mutex_unlock(&reader.lock);
+
+            if (fed < 0) {
+                break;
+            }
+        }
+
+        pthread_join(thread, NULL);
+
+        if (reader.err != 0) {
+            errno = reader.err;
+            code  = -1;
+        }
+    }
+
+    pthread_cond_destroy(&reader.cond);
+    pthread_mutex_destroy(&reader.lock);
+    free(second);
+
+    return code;
+}
+
+static void *reader_run(void *arg) {
+    reader_t *reader = arg;
+
+    for (size_t i = 1;; i ^= 1) {
+        reader_slot_t *slot = &reader->slots[i];
+
+        pthread_mutex_lock(&reader->lock);
+        while (slot->full && !reader->done) {
+            pthread_cond_wait(&reader->cond, &reader->lock);
+        }
+        bool stop = reader->done;
+        pthread_mutex_unlock(&reader->lock);
+
+        if (stop) {
+            break;
+        }
+
+        ssize_t n = reader_fill(reader->fd, slot->data, READER_BUFFER_SIZE);
+
+        pthread_mutex_lock(&reader->lock);
+        if (n < 0) {
+            reader->err  = errno;
+            reader->done = true;
+        } else {
+            slot->len  = n;
+            slot->full = true;
+            if ((size_t) n < READER_BUFFER_SIZE) {
+                reader->done = true;
+            }
+        }
+        pthread_cond_broadcast(&reader->cond);
+        pthread_mutex_unlock(&reader->lock);
+
+        if (n < 0 || (size_t) n < READER_BUFFER_SIZE) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// Appends a line fragment that straddles two chunks to the carry buffer.
+static bool splitter_carry(line_splitter_t *splitter, const char *data, size_t len) {
+    size_t required = splitter->carrylen + len + 1;
+
+    if (required > splitter->carrycap) {
+        size_t cap = max(splitter->carrycap * 2, required);
+        char  *p   = realloc(splitter->carry, cap);
+
+        if (p == NULL) {
+            errno = ENOMEM;
+            return false;
+        }
+
+        splitter->carry    = p;
+        splitter->carrycap = cap;
+    }
+
+    memcpy(splitter->carry + splitter->carrylen, data, len);
+    splitter->carrylen += len;
+    splitter->carry[splitter->carrylen] = '\0';
+
+    return true;
+}
+
+static int splitter_feed(line_splitter_t *splitter, char *data, size_t len) {
+    char *start = data;
+    char *end   = data + len;
+
+    while (start < end) {
+        char *nl = memchr(start, '\n', end - start);
+
+        if (nl == NULL) {
+            return splitter_carry(splitter, start, end - start) ? 0 : -1;
+        }
+
+        *nl = '\0';
+
+        if (splitter->carrylen > 0) {
+            if (!splitter_carry(splitter, start, nl - start)) {
+                return -1;
+            }
+            splitter->handler(splitter->carry, splitter->carrylen, splitter->ctx);
+            splitter->carrylen = 0;
+        } else {
+            splitter->handler(start, nl - start, splitter->ctx);
+        }
+
+        start = nl + 1;
+    }
+
+    return 0;
+}
+
+// Flushes a final line that was not terminated by '\n'.
+static void splitter_finish(line_splitter_t *splitter) {
+    if (splitter->carrylen > 0) {
+        splitter->handler(splitter->carry, splitter->carrylen, splitter->ctx);
+        splitter->carrylen = 0;
+    }
+
+    free(splitter->carry);
+    splitter->carry = NULL;
+}
@@ -0,0 +1,20 @@
+#ifndef READER_H
+#define READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Size of each chunk handed from the reader to the line splitter.
+#ifndef READER_BUFFER_SIZE
+# define READER_BUFFER_SIZE (64 * 1024)
+#endif // READER_BUFFER_SIZE
+
+// Path that selects standard input instead of a file.
+#define READER_STDIN_PATH "-"
+
+typedef void(line_handler_func)(char *line, size_t len, void *ctx);
+
+int  reader_read_lines(const char *path, line_handler_func *handler, void *ctx);
+bool reader_is_stdin(const char *path);
+
+#endif // READER_H
@@ -0,0 +1,515 @@
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <reader.h>
+#include <regex.h>
+#include <schema.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <trie.h>
+
+typedef enum SchemaType {
+    SCHEMA_STRING,
+    SCHEMA_INT,
+    SCHEMA_NUMBER,
+    SCHEMA_BOOL,
+    SCHEMA_URL,
+    SCHEMA_ENUM,
+    SCHEMA_REGEX,
+} schema_type_t;
+
+struct SchemaRule {
+    schema_type_t  type;
+    char          *desc;
+    bool           has_min;
+    bool           has_max;
+    double         min;    // bounds of number rules
+    double         max;
+    long long      intmin; // bounds of int rules and string lengths
+    long long      intmax;
+    char         **choicev;
+    size_t         choicec;
+    regex_t        regex;
+    bool           compiled;
+    schema_rule_t *next;   // next rule of the schema, which owns them
+};
+
+// Keyed by variable name in a trie, so lookups don't degrade as the number of
+// rules grows.
+struct Schema {
+    trie_t         rules;
+    schema_rule_t *head;
+};
+
+typedef struct SchemaParser {
+    schema_t *schema;
+    char     *errbuf;
+    size_t    lineno;
+    bool      failed;
+} schema_parser_t;
+
+static void           schema_rule_free(schema_rule_t *rule);
+static void           schema_handle_line(char *line, size_t len, void *ctx);
+static schema_rule_t *schema_parse_rule(char *spec, schema_parser_t *parser);
+static bool           schema_parse_range(schema_rule_t *rule, char *args, schema_parser_t *parser);
+static bool           schema_parse_choices(schema_rule_t *rule, char *args, schema_parser_t *parser);
+static bool           schema_parse_double(const char *str, double *out);
+static bool           schema_parse_int(const char *str, long long *out);
+static const char    *schema_skip_digits(const char *str);
+static bool           schema_in_range(const schema_rule_t *rule, double value);
+static bool           schema_in_int_range(const schema_rule_t *rule, long long value);
+static bool           schema_is_bool(const char *value);
+static bool           schema_is_url(const char *value);
+static char          *schema_trim(char *str);
+static void           schema_error(schema_parser_t *parser, const char *fmt, ...);
+
+// ==== Implementations =======================================================/
+// Parses and compiles every rule of the schema at `path` up front, so checking
+// a value is a lookup plus a single precompiled test. Returns NULL and
+// fills `errbuf` (of SCHEMA_ERR_SIZE bytes) if the schema can't be used.
+schema_t *schema_load(const char *path, char *errbuf) {
+    assert(path != NULL);
+    assert(errbuf != NULL);
+
+    schema_t *schema = malloc(sizeof(*schema));
+
+    if (schema == NULL) {
+        snprintf(errbuf, SCHEMA_ERR_SIZE, "Failed to allocate memory");
+        return NULL;
+    }
+
+    schema->rules = trie_create();
+    schema->head  = NULL;
+
+    schema_parser_t parser = {.schema = schema, .errbuf = errbuf, .lineno = 0, .failed = false};
+
+    if (reader_read_lines(path, schema_handle_line, &parser) != 0) {
+        if (errno == ENOENT) {
+            snprintf(errbuf, SCHEMA_ERR_SIZE, "File '%s' does not exist", path);
+        } else {
+            snprintf(errbuf, SCHEMA_ERR_SIZE, "Failed to read file '%s'", path);
+        }
+        parser.failed = true;
+    }
+
+    if (parser.failed) {
+        schema_free(schema);
+        return NULL;
+    }
+
+    return schema;
+}
+
+void schema_free(schema_t *schema) {
+    if (schema == NULL) {
+        return;
+    }
+
+    while (schema->head != NULL) {
+        schema_rule_t *rule = schema->head;
+        schema->head        = rule->next;
+        schema_rule_free(rule);
+    }
+
+    trie_free(&schema->rules);
+    free(schema);
+}
+
+const schema_rule_t *schema_find(const schema_t *schema, const char *key) {
+    if (schema == NULL || key == NULL) {
+        return NULL;
+    }
+
+    return trie_get((trie_t *) &schema->rules, key);
+}
+
+bool schema_rule_check(const schema_rule_t *rule, const char *value, size_t len) {
+    assert(rule != NULL);
+    assert(value != NULL);
+
+    double    num    = 0;
+    long long intnum = 0;
+
+    switch (rule->type) {
+        case SCHEMA_STRING:
+            return schema_in_int_range(rule, (long long) len);
+        case SCHEMA_INT:
+            return schema_parse_int(value, &intnum) && schema_in_int_range(rule, intnum);
+        case SCHEMA_NUMBER:
+            return schema_parse_double(value, &num) && schema_in_range(rule, num);
+        case SCHEMA_BOOL:
+            return schema_is_bool(value);
+        case SCHEMA_URL:
+            return schema_is_url(value);
+        case SCHEMA_ENUM:
+            for (size_t i = 0; i < rule->choicec; ++i) {
+                if (strcmp(value, rule->choicev[i]) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        case SCHEMA_REGEX:
+            return regexec(&rule->regex, value, 0, NULL, 0) == 0;
+    }
+
+    return false;
+}
+
+// The type exactly as written in the schema, e.g. "int(1..64)".
+const char *schema_rule_desc(const schema_rule_t *rule) {
+    assert(rule != NULL);
+    return rule->desc;
+}
+
+static void schema_rule_free(schema_rule_t *rule) {
+    if (rule == NULL) {
+        return;
+    }
+
+    if (rule->compiled) {
+        regfree(&rule->regex);
+    }
+
+    for (size_t i = 0; i < rule->choicec; ++i) {
+        free(rule->choicev[i]);
+    }
+
+    free(rule->choicev);
+    free(rule->desc);
+    free(rule);
+}
+
+static void schema_handle_line(char *line, size_t len, void *ctx) {
+    (void) len;
+    schema_parser_t *parser = ctx;
+    parser->lineno += 1;
+
+    if (parser->failed) {
+        return;
+    }
+
+    char *trimmed = schema_trim(line);
+
+    if (*trimmed == '\0' || *trimmed == '#') {
+        return;
+    }
+
+    char *delimpos = strchr(trimmed, '=');
+
+    if (delimpos == NULL) {
+        schema_error(parser, "expected KEY=TYPE");
+        return;
+    }
+
+    *delimpos       = '\0';
+    const char *key = schema_trim(trimmed);
+
+    if (*key == '\0') {
+        schema_error(parser, "missing variable name");
+        return;
+    }
+
+    if (trie_get(&parser->schema->rules, key) != NULL) {
+        schema_error(parser, "duplicate rule for '%s'", key);
+        return;
+    }
+
+    schema_rule_t *rule = schema_parse_rule(schema_trim(delimpos + 1), parser);
+
+    if (rule == NULL) {
+        return;
+    }
+
+    rule->next           = parser->schema->head;
+    parser->schema->head = rule;
+
+    if (!trie_put(&parser->schema->rules, key, rule)) {
+        schema_error(parser, "failed to allocate memory");
+    }
+}
+
+static schema_rule_t *schema_parse_rule(char *spec, schema_parser_t *parser) {
+    schema_rule_t *rule = calloc(1, sizeof(*rule));
+
+    if (rule == NULL || (rule->desc = strdup(spec)) == NULL) {
+        free(rule);
+        schema_error(parser, "failed to allocate memory");
+        return NULL;
+    }
+
+    char *args = strchr(spec, '(');
+
+    if (args != NULL) {
+        size_t speclen = strlen(spec);
+
+        if (spec[speclen - 1] != ')') {
+            schema_error(parser, "unterminated arguments in '%s'", rule->desc);
+            schema_rule_free(rule);
+            return NULL;
+        }
+
+        spec[speclen - 1] = '\0';
+        *args++           = '\0';
+    }
+
+    bool ok = true;
+
+    if (strcmp(spec, "string") == 0) {
+        rule->type = SCHEMA_STRING;
+        ok         = args == NULL || schema_parse_range(rule, args, parser);
+    } else if (strcmp(spec, "int") == 0) {
+        rule->type = SCHEMA_INT;
+        ok         = args == NULL || schema_parse_range(rule, args, parser);
+    } else if (strcmp(spec, "number") == 0) {
+        rule->type = SCHEMA_NUMBER;
+        ok         = args == NULL || schema_parse_range(rule, args, parser);
+    } else if (strcmp(spec, "port") == 0 && args == NULL) {
+        rule->type    = SCHEMA_INT;
+        rule->has_min = rule->has_max = true;
+        rule->intmin                  = 1;
+        rule->intmax                  = 65535;
+    } else if (strcmp(spec, "bool") == 0 && args == NULL) {
+        rule->type = SCHEMA_BOOL;
+    } else if (strcmp(spec, "url") == 0 && args == NULL) {
+        rule->type = SCHEMA_URL;
+    } else if (strcmp(spec, "enum") == 0 && args != NULL) {
+        rule->type = SCHEMA_ENUM;
+        ok         = schema_parse_choices(rule, args, parser);
+    } else if (strcmp(spec, "regex") == 0 && args != NULL) {
+        rule->type = SCHEMA_REGEX;
+        int code   = regcomp(&rule->regex, args, REG_EXTENDED | REG_NOSUB);
+
+        if (code != 0) {
+            char msg[256];
+            regerror(code, &rule->regex, msg, sizeof(msg));
+            schema_error(parser, "invalid regex '%s': %s", args, msg);
+            ok = false;
+        } else {
+            rule->compiled = true;
+        }
+    } else {
+        schema_error(parser, "unknown type '%s'", rule->desc);
+        ok = false;
+    }
+
+    if (!ok) {
+        schema_rule_free(rule);
+        return NULL;
+    }
+
+    return rule;
+}
+
+// Parses "min..max" where either bound may be left out, e.g. "1.." or "..64".
+// Only number rules take fractional bounds.
+static bool schema_parse_range(schema_rule_t *rule, char *args, schema_parser_t *parser) {
+    char *sep = strstr(args, "..");
+
+    if (sep == NULL) {
+        schema_error(parser, "expected a range like 'min..max' in '%s'", rule->desc);
+        return false;
+    }
+
+    *sep            = '\0';
+    const char *min = schema_trim(args);
+    const char *max = schema_trim(sep + 2);
+
+    rule->has_min = *min != '\0';
+    rule->has_max = *max != '\0';
+
+    bool ok    = true;
+    bool empty = false;
+
+    if (rule->type == SCHEMA_NUMBER) {
+        ok = (!rule->has_min || schema_parse_double(min, &rule->min)) &&
+             (!rule->has_max || schema_parse_double(max, &rule->max));
+        empty = rule->min > rule->max;
+    } else {
+        ok = (!rule->has_min || schema_parse_int(min, &rule->intmin)) &&
+             (!rule->has_max || schema_parse_int(max, &rule->intmax));
+        empty = rule->intmin > rule->intmax;
+    }
+
+    if (!ok) {
+        schema_error(parser, "invalid range bound in '%s'", rule->desc);
+        return false;
+    }
+
+    if (rule->has_min && rule->has_max && empty) {
+        schema_error(parser, "empty range in '%s'", rule->desc);
+        return false;
+    }
+
+    return true;
+}
+
+static bool schema_parse_choices(schema_rule_t *rule, char *args, schema_parser_t *parser) {
+    size_t choicec = 1;
+    for (const char *p = args; *p != '\0'; ++p) {
+        if (*p == '|') {
+            choicec += 1;
+        }
+    }
+
+    rule->choicev = calloc(choicec, sizeof(*rule->choicev));
+
+    if (rule->choicev == NULL) {
+        schema_error(parser, "failed to allocate memory");
+        return false;
+    }
+
+    for (char *choice = args, *next = NULL; choice != NULL; choice = next) {
+        next = strchr(choice, '|');
+
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+
+        choice = schema_trim(choice);
+
+        if (*choice == '\0') {
+            schema_error(parser, "empty choice in '%s'", rule->desc);
+            return false;
+        }
+
+        if ((rule->choicev[rule->choicec] = strdup(choice)) == NULL) {
+            schema_error(parser, "failed to allocate memory");
+            return false;
+        }
+
+        rule->choicec += 1;
+    }
+
+    return true;
+}
+
+// Accepts plain decimals only: an optional '-', digits, an optional fraction
+// and an optional exponent. strtod on its own would also take a leading '+',
+// "nan", "inf" and hex floats.
+static bool schema_parse_double(const char *str, double *out) {
+    const char *p = schema_skip_digits(*str == '-' ? str + 1 : str);
+
+    if (p == NULL) {
+        return false;
+    }
+
+    if (*p == '.') {
+        p = schema_skip_digits(p + 1);
+    }
+
+    if (p != NULL && (*p == 'e' || *p == 'E')) {
+        p = schema_skip_digits(p[1] == '+' || p[1] == '-' ? p + 2 : p + 1);
+    }
+
+    if (p == NULL || *p != '\0') {
+        return false;
+    }
+
+    *out = strtod(str, NULL);
+    return isfinite(*out);
+}
+
+// An optional '-' and digits, within the range of a long long.
+static bool schema_parse_int(const char *str, long long *out) {
+    const char *p = schema_skip_digits(*str == '-' ? str + 1 : str);
+
+    if (p == NULL || *p != '\0') {
+        return false;
+    }
+
+    errno = 0;
+    *out  = strtoll(str, NULL, 10);
+    return errno != ERANGE;
+}
+
+// Skips a non-empty run of digits, NULL if `str` doesn't start with a digit.
+static const char *schema_skip_digits(const char *str) {
+    if (!isdigit((unsigned char) *str)) {
+        return NULL;
+    }
+
+    while (isdigit((unsigned char) *str)) {
+        ++str;
+    }
+
+    return str;
+}
+
+static bool schema_in_range(const schema_rule_t *rule, double value) {
+    return (!rule->has_min || value >= rule->min) && (!rule->has_max || value <= rule->max);
+}
+
+static bool schema_in_int_range(const schema_rule_t *rule, long long value) {
+    return (!rule->has_min || value >= rule->intmin) && (!rule->has_max || value <= rule->intmax);
+}
+
+static bool schema_is_bool(const char *value) {
+    static const char *boolv[] = {"true", "false", "1", "0", "yes", "no", "on", "off"};
+
+    for (size_t i = 0; i < sizeof(boolv) / sizeof(*boolv); ++i) {
+        if (strcasecmp(value, boolv[i]) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Accepts "scheme://host[...]" without any whitespace.
+static bool schema_is_url(const char *value) {
+    const char *p = value;
+
+    if (!isalpha((unsigned char) *p)) {
+        return false;
+    }
+
+    while (isalnum((unsigned char) *p) || *p == '+' || *p == '-' || *p == '.') {
+        ++p;
+    }
+
+    if (strncmp(p, "://", 3) != 0) {
+        return false;
+    }
+
+    p += 3;
+
+    if (*p == '\0' || *p == '/') {
+        return false;
+    }
+
+    for (; *p != '\0'; ++p) {
+        if (isspace((unsigned char) *p)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static char *schema_trim(char *str) {
+    while (isspace((unsigned char) *str)) {
+        ++str;
+    }
+
+    size_t len = strlen(str);
+    while (len > 0 && isspace((unsigned char) str[len - 1])) {
+        str[--len] = '\0';
+    }
+
+    return str;
+}
+
+static void schema_error(schema_parser_t *parser, const char *fmt, ...) {
+    int written = snprintf(parser->errbuf, SCHEMA_ERR_SIZE, "line %zu: ", parser->lineno);
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(parser->errbuf + written, SCHEMA_ERR_SIZE - written, fmt, args);
+    va_end(args);
+
+    parser->failed = true;
+}
@@ -0,0 +1,31 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Rules are read from lines like:
+//
+//   PORT=port
+//   WORKERS=int(1..64)
+//   RATIO=number(0..1)
+//   NAME=string(1..32)
+//   DEBUG=bool
+//   APP_URL=url
+//   LOG_LEVEL=enum(debug|info|warn|error)
+//   API_KEY=regex(^[A-Za-z0-9]{32}$)
+//
+// Blank lines and lines starting with '#' are ignored.
+
+#define SCHEMA_ERR_SIZE 1024
+
+typedef struct Schema     schema_t;
+typedef struct SchemaRule schema_rule_t;
+
+schema_t            *schema_load(const char *path, char *errbuf);
+void                 schema_free(schema_t *schema);
+const schema_rule_t *schema_find(const schema_t *schema, const char *key);
+bool                 schema_rule_check(const schema_rule_t *rule, const char *value, size_t len);
+const char          *schema_rule_desc(const schema_rule_t *rule);
+
+#endif // SCHEMA_H
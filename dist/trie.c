@@ -0,0 +1,321 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <trie.h>
+
+typedef struct TrieFrame {
+    trie_node_t *node;
+    size_t       next;   // index of the next child to visit
+    size_t       keylen; // length of the key up to the end of the node's edge
+} trie_frame_t;
+
+static trie_node_t *trie_create_node(const char *edge, size_t edgelen);
+static size_t       trie_child_index(const trie_node_t *node, char c, bool *found);
+static bool         trie_insert_child(trie_node_t *node, size_t i, trie_node_t *child);
+static trie_node_t *trie_locate(trie_t *trie, const char *prefix, size_t *start);
+
+// ==== Implementations =======================================================/
+trie_t trie_create(void) {
+    trie_t trie = {
+        .root   = NULL,
+        .size   = 0,
+        .maxlen = 0,
+    };
+
+    return trie;
+}
+
+// Iterative, so a long chain of nodes can't exhaust the stack. The value
+// pointers are no longer needed and link the nodes that are still to be freed.
+void trie_free(trie_t *trie) {
+    if (trie == NULL || trie->root == NULL) {
+        return;
+    }
+
+    trie_node_t *pending = trie->root;
+    pending->value       = NULL;
+
+    while (pending != NULL) {
+        trie_node_t *node = pending;
+        pending           = node->value;
+
+        for (size_t i = 0; i < node->childc; ++i) {
+            node->children[i]->value = pending;
+            pending                  = node->children[i];
+        }
+
+        free(node->children);
+        free(node);
+    }
+
+    trie->root   = NULL;
+    trie->size   = 0;
+    trie->maxlen = 0;
+}
+
+// Values are borrowed: the trie never frees them.
+bool trie_put(trie_t *trie, const char *key, void *value) {
+    assert(trie != NULL);
+    assert(key != NULL);
+
+    if (trie->root == NULL && (trie->root = trie_create_node("", 0)) == NULL) {
+        return false;
+    }
+
+    trie_node_t *node = trie->root;
+    const char  *p    = key;
+
+    while (*p != '\0') {
+        bool         found = false;
+        size_t       i     = trie_child_index(node, *p, &found);
+        trie_node_t *child = found ? node->children[i] : NULL;
+
+        if (child == NULL) {
+            child = trie_create_node(p, strlen(p));
+
+            if (child == NULL || !trie_insert_child(node, i, child)) {
+                free(child);
+                return false;
+            }
+
+            p += child->edgelen;
+            node = child;
+            break;
+        }
+
+        size_t common = 1;
+        while (common < child->edgelen && p[common] == child->edge[common]) {
+            ++common;
+        }
+
+        if (common < child->edgelen) {
+            // split the edge, the child keeps its address and the tail of it
+            trie_node_t *mid = trie_create_node(child->edge, common);
+
+            if (mid == NULL || !trie_insert_child(mid, 0, child)) {
+                free(mid);
+                return false;
+            }
+
+            child->edgelen -= common;
+            memmove(child->edge, child->edge + common, child->edgelen);
+            node->children[i] = mid;
+            child             = mid;
+        }
+
+        p += common;
+        node = child;
+    }
+
+    if (node->value == NULL) {
+        trie->size += 1;
+    }
+
+    node->value = value;
+
+    size_t len = (size_t) (p - key);
+    if (len > trie->maxlen) {
+        trie->maxlen = len;
+    }
+
+    return true;
+}
+
+void *trie_get(trie_t *trie, const char *key) {
+    size_t       start = 0;
+    trie_node_t *node  = trie_locate(trie, key, &start);
+
+    return node != NULL && start + node->edgelen == strlen(key) ? node->value : NULL;
+}
+
+// Returns the topmost node whose key starts with `prefix`, in O(prefix).
+trie_node_t *trie_find_prefix(trie_t *trie, const char *prefix) {
+    size_t start = 0;
+    return trie_locate(trie, prefix, &start);
+}
+
+// Depth first walk in lexicographical key order over every key starting with
+// `prefix`. Iterative, with one frame per node on the current path. Returns
+// false when out of memory.
+bool trie_walk(trie_t *trie, const char *prefix, trie_enter_func *enter, trie_leave_func *leave, void *ctx) {
+    assert(trie != NULL);
+    assert(prefix != NULL);
+
+    size_t       start = 0;
+    trie_node_t *node  = trie_locate(trie, prefix, &start);
+
+    if (node == NULL) {
+        return true;
+    }
+
+    char         *key    = malloc(trie->maxlen + 1);
+    size_t        cap    = 16;
+    trie_frame_t *framev = malloc(cap * sizeof(*framev));
+
+    if (key == NULL || framev == NULL) {
+        free(key);
+        free(framev);
+        return false;
+    }
+
+    size_t keylen = start + node->edgelen;
+    memcpy(key, prefix, start);
+    memcpy(key + start, node->edge, node->edgelen);
+    key[keylen] = '\0';
+
+    size_t framec = 0;
+    if (enter == NULL || enter(node, key, keylen, 0, ctx)) {
+        framev[framec++] = (trie_frame_t) {.node = node, .next = 0, .keylen = keylen};
+    }
+
+    while (framec > 0) {
+        trie_frame_t *frame = &framev[framec - 1];
+
+        if (frame->next < frame->node->childc) {
+            trie_node_t *child = frame->node->children[frame->next++];
+
+            keylen = frame->keylen + child->edgelen;
+            memcpy(key + frame->keylen, child->edge, child->edgelen);
+            key[keylen] = '\0';
+
+            if (enter != NULL && !enter(child, key, keylen, framec, ctx)) {
+                continue;
+            }
+
+            if (framec == cap) {
+                trie_frame_t *grown = realloc(framev, cap * 2 * sizeof(*framev));
+
+                if (grown == NULL) {
+                    free(key);
+                    free(framev);
+                    return false;
+                }
+
+                framev = grown;
+                cap *= 2;
+            }
+
+            framev[framec++] = (trie_frame_t) {.node = child, .next = 0, .keylen = keylen};
+            continue;
+        }
+
+        framec -= 1;
+        key[frame->keylen] = '\0';
+
+        if (leave != NULL) {
+            leave(frame->node, key, frame->keylen, framec, ctx);
+        }
+    }
+
+    free(key);
+    free(framev);
+
+    return true;
+}
+
+static trie_node_t *trie_create_node(const char *edge, size_t edgelen) {
+    trie_node_t *node = malloc(sizeof(*node) + edgelen);
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    node->value    = NULL;
+    node->children = NULL;
+    node->childc   = 0;
+    node->childcap = 0;
+    node->edgelen  = edgelen;
+    memcpy(node->edge, edge, edgelen);
+
+    return node;
+}
+
+// Position of the child whose edge starts with `c`, or where it would go.
+static size_t trie_child_index(const trie_node_t *node, char c, bool *found) {
+    size_t lo = 0;
+    size_t hi = node->childc;
+
+    while (lo < hi) {
+        size_t        mid   = lo + (hi - lo) / 2;
+        unsigned char first = (unsigned char) node->children[mid]->edge[0];
+
+        if (first == (unsigned char) c) {
+            *found = true;
+            return mid;
+        }
+
+        if (first < (unsigned char) c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *found = false;
+    return lo;
+}
+
+static bool trie_insert_child(trie_node_t *node, size_t i, trie_node_t *child) {
+    if (node->childc == node->childcap) {
+        size_t        cap      = node->childcap ? node->childcap * 2 : 2;
+        trie_node_t **children = realloc(node->children, cap * sizeof(*children));
+
+        if (children == NULL) {
+            return false;
+        }
+
+        node->children = children;
+        node->childcap = cap;
+    }
+
+    memmove(node->children + i + 1, node->children + i, (node->childc - i) * sizeof(*node->children));
+    node->children[i] = child;
+    node->childc += 1;
+
+    return true;
+}
+
+// Finds the topmost node whose key starts with `prefix`. Its key is the first
+// `start` chars of `prefix` followed by its edge, which may run past `prefix`.
+static trie_node_t *trie_locate(trie_t *trie, const char *prefix, size_t *start) {
+    assert(trie != NULL);
+    assert(prefix != NULL);
+
+    trie_node_t *node = trie->root;
+    size_t       len  = 0;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    while (prefix[len] != '\0') {
+        bool   found = false;
+        size_t i     = trie_child_index(node, prefix[len], &found);
+
+        if (!found) {
+            return NULL;
+        }
+
+        trie_node_t *child  = node->children[i];
+        size_t       offset = 1;
+
+        while (offset < child->edgelen && prefix[len + offset] != '\0') {
+            if (child->edge[offset] != prefix[len + offset]) {
+                return NULL;
+            }
+
+            ++offset;
+        }
+
+        if (offset < child->edgelen) {
+            *start = len;
+            return child;
+        }
+
+        len += child->edgelen;
+        node = child;
+    }
+
+    *start = len - node->edgelen;
+    return node;
+}
@@ -0,0 +1,38 @@
+#ifndef TRIE_H
+#define TRIE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Path compressed: every edge holds a key fragment, so a key costs one node
+// plus its bytes and the depth of a node is its number of branch points, not
+// the length of its key.
+typedef struct TrieNode {
+    void             *value;
+    struct TrieNode **children; // sorted by the first char of their edge
+    size_t            childc;
+    size_t            childcap;
+    size_t            edgelen;
+    char              edge[]; // key fragment between the parent and this node
+} trie_node_t;
+
+typedef struct Trie {
+    trie_node_t *root;
+    size_t       size;
+    size_t       maxlen;
+} trie_t;
+
+// Called when the walk enters a node whose full key is `key`; return false to
+// skip its subtree. `depth` counts the nodes between the walk start and `node`.
+typedef bool(trie_enter_func)(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx);
+// Called when the walk leaves a node, after all of its children.
+typedef void(trie_leave_func)(trie_node_t *node, const char *key, size_t keylen, size_t depth, void *ctx);
+
+trie_t       trie_create(void);
+void         trie_free(trie_t *trie);
+bool         trie_put(trie_t *trie, const char *key, void *value);
+void        *trie_get(trie_t *trie, const char *key);
+trie_node_t *trie_find_prefix(trie_t *trie, const char *prefix);
+bool trie_walk(trie_t *trie, const char *prefix, trie_enter_func *enter, trie_leave_func *leave, void *ctx);
+
+#endif // TRIE_H